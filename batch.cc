@@ -0,0 +1,494 @@
+/*********************************************************
+File name: batch.cc
+File function: solve many festival instances in a single
+process. The instances are given by a manifest with pairs
+of input and output files (or by a directory) and are
+solved by a fixed pool of threads, each instance with the
+greedy (greedy.h), the metaheuristic (mh.h) or the
+exhaustive algorithm (exh.h) and its own time budget, or
+with a portfolio that runs the exhaustive search and
+several metaheuristic ones at the same time sharing their
+bounds. When every instance is solved, a summary table
+with the days and times of each one is written.
+**********************************************************/
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <unistd.h>
+#include <dirent.h>
+#include "greedy.h"
+#include "exh.h"
+#include "mh.h"
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+using Clock = chrono::steady_clock; // Wall clock; clock() would add up the
+// time of every thread
+
+struct Job {
+  string input_file, output_file; // Files to read input and write output
+  string solver; // "greedy", "mh", "exh" or "portfolio"
+  double budget; // Seconds the solver may run
+  int films; // Films of the instance (-1 if it could not be read)
+  int days; // Days of the best schedule found
+  int lower; // Days no schedule can go below
+  double load_time; // Seconds spent reading the instance
+  double solve_time; // Seconds spent solving it
+  string status; // "optimal", "heuristic", "budget" or "unreadable"
+};
+
+struct Bounds {
+  Clock::time_point start; // When the job started solving
+  Clock::time_point deadline; // When its searches have to stop
+  double budget; // Seconds they may run
+  atomic<int> upper; // Days of the best schedule found by any solver
+  atomic<int> lower; // Days no schedule can go below; the job is solved
+  // when both bounds meet
+  mutex best_mutex; // Protects best and best_time
+  Organization best; // Best schedule found
+  double best_time; // Seconds it took to find it
+};
+
+int n_threads; // Threads the jobs may keep busy at the same time
+int portfolio_threads; // Threads of each portfolio job
+double default_budget; // Budget of the jobs that do not give one
+string default_solver; // Solver of the jobs that do not give one
+string summary_file; // Where to write the summary ("-" is the standard output)
+string renumbering; // Order of the film numbers: "none" keeps the order of
+// the input, "degree" or "rcm" (see renumber)
+
+const int PORTFOLIO_SEEDS = 1000; // Seeds of the searches of a portfolio
+// are seed*PORTFOLIO_SEEDS + i, so jobs never share them
+const int CLIQUE_SEEDS = 32; // Films from which cliques are grown for the
+// lower bound
+
+vector<Job> jobs; // Instances to solve
+atomic<int> next_job; // First job no thread has taken yet
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: seconds_since
+* Function: Computes the seconds elapsed since a moment.
+* Parameters: start: The moment.
+* Return: Seconds elapsed.
+-------------------------------------------------------- */
+double seconds_since(Clock::time_point start){
+  return chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* --------------------------------------------------------
+* Name: solved
+* Function: Checks whether the bounds of the job have met,
+            so that no search can improve the best schedule.
+* Parameters: bounds: Bounds of the job.
+* Return: True if the best schedule is optimal.
+-------------------------------------------------------- */
+bool solved(const Bounds& bounds){
+  return bounds.upper.load(memory_order_relaxed) <= bounds.lower.load(memory_order_relaxed);
+}
+
+/* --------------------------------------------------------
+* Name: record
+* Function: Keeps a schedule as the best one of the job if
+            it has fewer days, tightening the upper bound
+            every search of the job prunes with.
+* Parameters: bounds: Bounds of the job.
+              actual: Schedule found, with no
+              incompatibilities.
+* Return: -
+-------------------------------------------------------- */
+void record(Bounds& bounds, const Organization& actual){
+  if (actual.days >= bounds.upper.load(memory_order_relaxed)) return;
+  lock_guard<mutex> lock(bounds.best_mutex);
+  // Another search may have found a better one meanwhile
+  if (actual.days < bounds.upper.load()){
+    // Same sizes, so copying does not allocate
+    bounds.best = actual;
+    bounds.best_time = seconds_since(bounds.start);
+    bounds.upper = actual.days;
+  }
+}
+
+/* --------------------------------------------------------
+* Name: clique_bound
+* Function: Computes a lower bound on the days: the films of
+            a clique of incompatibilities need a day each,
+            and each day has at most n_CinRooms films. The
+            cliques are built greedily from the films with
+            most restrictions.
+* Parameters: instance: Instance.
+* Return: Days no schedule can go below.
+-------------------------------------------------------- */
+int clique_bound(const Instance& instance){
+  int bound = (instance.n_films + instance.n_CinRooms - 1)/instance.n_CinRooms;
+  vector<int> clique;
+  for (int seed = 0; seed < min(instance.n_films, CLIQUE_SEEDS); ++seed){
+    clique.assign(1, instance.restrictions[seed].first);
+    for (int i = 0; i < instance.n_films; ++i){
+      int code = instance.restrictions[i].first;
+      bool adjacent = true;
+      for (int k = 0; k < int(clique.size()) and adjacent; ++k) adjacent = instance.relations_graph[code][clique[k]];
+      if (adjacent) clique.push_back(code);
+    }
+    bound = max(bound, int(clique.size()));
+  }
+  return bound;
+}
+
+/* --------------------------------------------------------
+* Name: found
+* Function: Called by the searches of a job with every
+            schedule that improves the best one they know:
+            records it for the whole job.
+* Parameters: search: Search.
+              actual: Schedule found.
+* Return: -
+-------------------------------------------------------- */
+void found(Search& search, const Organization& actual){
+  record(*(Bounds*)search.data, actual);
+}
+
+/* --------------------------------------------------------
+* Name: interrupted
+* Function: Called by the searches of a job from time to
+            time: they prune with the best schedule found by
+            any of them and stop when the budget is over or
+            the bounds of the job meet.
+* Parameters: search: Search.
+* Return: True if the search has to stop.
+-------------------------------------------------------- */
+bool interrupted(Search& search){
+  const Bounds& bounds = *(const Bounds*)search.data;
+  search.elapsed = seconds_since(bounds.start);
+  search.best_days = min(search.best_days, bounds.upper.load(memory_order_relaxed));
+  return Clock::now() >= bounds.deadline or solved(bounds);
+}
+
+/* --------------------------------------------------------
+* Name: prepare
+* Function: Prepares a search of a job, starting from the
+            best schedule found so far.
+* Parameters: search: Search to prepare.
+              instance: Instance of the job.
+              bounds: Bounds of the job.
+              seed: Seed of its random generator.
+* Return: -
+-------------------------------------------------------- */
+void prepare(Search& search, const Instance& instance, Bounds& bounds, unsigned seed){
+  search.instance = &instance;
+  search.best_days = bounds.upper;
+  search.rng.seed(seed);
+  search.time_limit = bounds.budget;
+  search.elapsed = 0;
+  search.found = found;
+  search.interrupted = interrupted;
+  search.data = &bounds;
+}
+
+/* --------------------------------------------------------
+* Name: exact
+* Function: Runs the exhaustive search of exh.h. If it
+            completes, no schedule has fewer days than the
+            best one found, so the lower bound rises to
+            meet it.
+* Parameters: bounds: Bounds of the job.
+              instance: Instance of the job.
+* Return: -
+-------------------------------------------------------- */
+void exact(Bounds& bounds, const Instance& instance){
+  Exhaustive search;
+  init_exhaustive(search, instance);
+  prepare(search, instance, bounds, 0);
+  Organization actual;
+  init_organization(actual, instance);
+  if (schedule_festival(search, actual)) bounds.lower = search.best_days;
+}
+
+/* --------------------------------------------------------
+* Name: local
+* Function: Runs the metaheuristic search of mh.h (GRASP)
+            for the mh solver and the portfolio.
+* Parameters: bounds: Bounds of the job.
+              instance: Instance of the job.
+              seed: Seed of its random generator.
+* Return: -
+-------------------------------------------------------- */
+void local(Bounds& bounds, const Instance& instance, unsigned seed){
+  Metaheuristic search;
+  init_metaheuristic(search, instance);
+  prepare(search, instance, bounds, seed);
+  metaheuristic(search);
+}
+
+/* --------------------------------------------------------
+* Name: portfolio
+* Function: Races the exhaustive search against several
+            metaheuristic searches, one per remaining thread
+            of the job and each with its own seed. Every
+            schedule found tightens the pruning of the
+            exhaustive search, and the metaheuristic ones
+            stop as soon as it proves the best schedule
+            optimal.
+* Parameters: instance: Instance of the job.
+              bounds: Bounds of the job, already seeded
+              with the greedy schedule.
+              seed: Seed of the first metaheuristic search.
+* Return: -
+-------------------------------------------------------- */
+void portfolio(const Instance& instance, Bounds& bounds, unsigned seed){
+  int n_local = portfolio_threads-1;
+  vector<thread> threads;
+  threads.push_back(thread(exact, ref(bounds), cref(instance)));
+  for (int i = 1; i <= n_local; ++i) threads.push_back(thread(local, ref(bounds), cref(instance), seed*PORTFOLIO_SEEDS + i));
+  for (int i = 0; i < int(threads.size()); ++i) threads[i].join();
+}
+
+/* --------------------------------------------------------
+* Name: run_job
+* Function: Reads, solves and writes the output of a job,
+            filling in its results.
+* Parameters: job: Job to run.
+              seed: Seed of its random generator.
+* Return: -
+-------------------------------------------------------- */
+void run_job(Job& job, unsigned seed){
+  Clock::time_point start = Clock::now();
+  Instance instance;
+  if (not read_data(job.input_file, instance)){
+    job.films = -1;
+    job.days = -1;
+    job.lower = -1;
+    job.load_time = seconds_since(start);
+    job.solve_time = 0;
+    job.status = "unreadable";
+    return;
+  }
+  // Renumbering is part of preparing the instance
+  renumber(instance, renumbering);
+  job.films = instance.n_films;
+  job.load_time = seconds_since(start);
+
+  Bounds bounds;
+  bounds.start = Clock::now();
+  bounds.budget = job.budget;
+  bounds.deadline = bounds.start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(job.budget));
+  bounds.upper = instance.n_films + 1;
+  bounds.lower = clique_bound(instance);
+  init_organization(bounds.best, instance);
+  bounds.best_time = 0;
+
+  // Start from the greedy schedule whatever the solver is: it is the first
+  // upper bound, and every job writes a schedule even with no budget left
+  Organization actual;
+  init_organization(actual, instance);
+  greedy(instance, actual);
+  record(bounds, actual);
+  if (job.solver == "exh") exact(bounds, instance);
+  else if (job.solver == "mh") local(bounds, instance, seed);
+  else if (job.solver == "portfolio") portfolio(instance, bounds, seed);
+
+  job.days = bounds.upper;
+  job.lower = bounds.lower;
+  if (job.days <= job.lower) job.status = "optimal";
+  else job.status = job.solver == "greedy" ? "heuristic" : "budget";
+  job.solve_time = seconds_since(bounds.start);
+  write_schedule(job.output_file, instance, bounds.best, bounds.best_time);
+}
+
+/* --------------------------------------------------------
+* Name: worker
+* Function: Takes jobs that no other thread has taken and
+            runs them until there are no more.
+* Parameters: -
+* Return: -
+-------------------------------------------------------- */
+void worker(){
+  for (int i = next_job++; i < int(jobs.size()); i = next_job++) run_job(jobs[i], i+1);
+}
+
+/* --------------------------------------------------------
+* Name: read_manifest
+* Function: Reads the jobs of a manifest: one job per line
+            with the input file, the output file and,
+            optionally, the solver and its budget in
+            seconds. Empty lines and lines starting with '#'
+            are skipped.
+* Parameters: file: Name of the manifest.
+* Return: True if the manifest could be read.
+-------------------------------------------------------- */
+bool read_manifest(const string& file){
+  ifstream in(file);
+  if (not in) return false;
+  string line;
+  while (getline(in, line)){
+    istringstream fields(line);
+    Job job;
+    if (not (fields >> job.input_file) or job.input_file[0] == '#') continue;
+    if (not (fields >> job.output_file)) return false;
+    if (not (fields >> job.solver)) job.solver = default_solver;
+    if (not (fields >> job.budget)) job.budget = default_budget;
+    jobs.push_back(job);
+  }
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: read_directory
+* Function: Creates a job for each file of a directory,
+            writing its output with the same name on another
+            directory.
+* Parameters: input_dir: Directory with the instances.
+              output_dir: Directory for the outputs.
+* Return: True if the directory could be read.
+-------------------------------------------------------- */
+bool read_directory(const string& input_dir, const string& output_dir){
+  DIR* dir = opendir(input_dir.c_str());
+  if (dir == nullptr) return false;
+  vector<string> names;
+  while (dirent* entry = readdir(dir)){
+    string name = entry->d_name;
+    struct stat info;
+    if (stat((input_dir + "/" + name).c_str(), &info) == 0 and S_ISREG(info.st_mode)) names.push_back(name);
+  }
+  closedir(dir);
+  // Always the same order, whatever the file system
+  sort(names.begin(), names.end());
+  for (int i = 0; i < int(names.size()); ++i){
+    Job job;
+    job.input_file = input_dir + "/" + names[i];
+    job.output_file = output_dir + "/" + names[i];
+    job.solver = default_solver;
+    job.budget = default_budget;
+    jobs.push_back(job);
+  }
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: write_summary
+* Function: Writes a table with the results of every job.
+* Parameters: out: Where to write it.
+* Return: -
+-------------------------------------------------------- */
+void write_summary(ostream& out){
+  out.setf(ios::fixed);
+  out.precision(3);
+  out << "input\tsolver\tfilms\tdays\tlower\tload\tsolve\tstatus" << endl;
+  for (int i = 0; i < int(jobs.size()); ++i){
+    const Job& job = jobs[i];
+    out << job.input_file << "\t" << job.solver << "\t" << job.films << "\t" << job.days << "\t" << job.lower << "\t"
+        << job.load_time << "\t" << job.solve_time << "\t" << job.status << endl;
+  }
+}
+
+/* --------------------------------------------------------
+* Name: usage
+* Function: Explains how to launch the program and stops it.
+* Parameters: -
+* Return: -
+-------------------------------------------------------- */
+void usage(){
+  cerr << "Usage: batch [--threads N] [--budget SECONDS] [--solver greedy|mh|exh|portfolio]" << endl
+       << "             [--summary FILE] [--renumber none|degree|rcm]" << endl
+       << "             (MANIFEST | --dir INPUT_DIR OUTPUT_DIR | --job INPUT OUTPUT)" << endl;
+  exit(1);
+}
+
+/***********************************************************
+                          MAIN
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: main
+* Function: main function
+* Parameters: argc: number of arguments passed when
+              launching the code
+              argv: arguments given
+* Return: 0
+-------------------------------------------------------- */
+int main(int argc, char** argv){
+  n_threads = max(1, int(thread::hardware_concurrency()));
+  default_budget = 10;
+  default_solver = "greedy";
+  summary_file = "-";
+  renumbering = "none";
+  string manifest, input_dir, output_dir;
+  vector<Job> single_jobs;
+  // Read the options
+  for (int i = 1; i < argc; ++i){
+    string option = argv[i];
+    if (option == "--threads" and i+1 < argc) n_threads = max(1, atoi(argv[++i]));
+    else if (option == "--budget" and i+1 < argc) default_budget = atof(argv[++i]);
+    else if (option == "--solver" and i+1 < argc) default_solver = argv[++i];
+    else if (option == "--summary" and i+1 < argc) summary_file = argv[++i];
+    else if (option == "--renumber" and i+1 < argc) renumbering = argv[++i];
+    else if (option == "--dir" and i+2 < argc){
+      input_dir = argv[++i];
+      output_dir = argv[++i];
+    }
+    else if (option == "--job" and i+2 < argc){
+      Job job;
+      job.input_file = argv[++i];
+      job.output_file = argv[++i];
+      single_jobs.push_back(job);
+    }
+    else if (option[0] != '-' and manifest.empty()) manifest = option;
+    else usage();
+  }
+  if (int(not manifest.empty()) + int(not input_dir.empty()) + int(not single_jobs.empty()) != 1) usage();
+  // The solver and budget options apply to the jobs given with --job
+  for (int i = 0; i < int(single_jobs.size()); ++i){
+    single_jobs[i].solver = default_solver;
+    single_jobs[i].budget = default_budget;
+    jobs.push_back(single_jobs[i]);
+  }
+  bool read = true;
+  if (not manifest.empty()) read = read_manifest(manifest);
+  else if (not input_dir.empty()) read = read_directory(input_dir, output_dir);
+  if (not read){
+    cerr << "Cannot read the jobs from " << (manifest.empty() ? input_dir : manifest) << endl;
+    return 1;
+  }
+  if (renumbering != "none" and renumbering != "degree" and renumbering != "rcm") usage();
+  for (int i = 0; i < int(jobs.size()); ++i){
+    const string& solver = jobs[i].solver;
+    if (solver != "greedy" and solver != "mh" and solver != "exh" and solver != "portfolio") usage();
+  }
+
+  // Solve the jobs with a fixed pool of threads. A portfolio job runs
+  // several searches at once (two at least), so when there are portfolio
+  // jobs fewer jobs are solved together and the threads are split among them
+  bool any_portfolio = false;
+  for (int i = 0; i < int(jobs.size()); ++i) if (jobs[i].solver == "portfolio") any_portfolio = true;
+  int workers = min(any_portfolio ? max(1, n_threads/2) : n_threads, int(jobs.size()));
+  portfolio_threads = max(2, n_threads/max(1, workers));
+  next_job = 0;
+  vector<thread> pool;
+  for (int i = 0; i < workers; ++i) pool.push_back(thread(worker));
+  for (int i = 0; i < int(pool.size()); ++i) pool[i].join();
+
+  // Write the summary
+  if (summary_file == "-") write_summary(cout);
+  else{
+    ofstream file(summary_file);
+    write_summary(file);
+  }
+}
@@ -0,0 +1,146 @@
+/*********************************************************
+File name: compile.cc
+File function: translate a festival instance from its text
+format into a binary file that exh, greedy and mh can
+memory-map directly, so that an instance solved many times
+is parsed only once. The binary file keeps the names of the
+films and cinema rooms, the incompatibilities as adjacency
+lists, how many incompatibilities each film has and the
+order in which the exact and greedy solvers place them.
+**********************************************************/
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include <cstdlib>
+#include "instance.h"
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+// Binary file layout (every field is a 32-bit word in host byte order):
+//   COMPILED_MAGIC, COMPILED_VERSION (see instance.h), n_films, n_PairsFilms, n_CinRooms, names_size,
+//   rooms_size, adjacency_size
+//   name_start[n_films+1]: where each film name starts in names
+//   room_start[n_CinRooms+1]: where each room name starts in rooms
+//   degree[n_films]: incompatibilities of each film
+//   order[n_films]: films sorted by decreasing incompatibilities
+//   adjacency_start[n_films+1]: where each film list starts in adjacency
+//   adjacency[adjacency_size]: incompatible films of each film
+//   names[names_size], rooms[rooms_size]: characters, padded to 32 bits
+
+string input_file, output_file; // Files to read input and write output
+
+Instance instance; // Instance being compiled
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: append_names
+* Function: Appends a list of names to a block of
+            characters, recording where each one starts.
+* Parameters: names: Names to append.
+              start: Where each name starts (output).
+              block: Characters of all the names (output).
+* Return: -
+-------------------------------------------------------- */
+void append_names(const vector<string>& names, vector<uint32_t>& start, string& block){
+  for (int i = 0; i < int(names.size()); ++i){
+    start.push_back(block.size());
+    block += names[i];
+  }
+  start.push_back(block.size());
+  // Keep the next section aligned to 32 bits
+  block.resize((block.size()+3)/4*4, '\0');
+}
+
+/* --------------------------------------------------------
+* Name: write
+* Function: Writes the instance on the output file with the
+            binary layout described above.
+* Parameters: -
+* Return: -
+-------------------------------------------------------- */
+void write(){
+  int n_films = instance.n_films;
+  vector<uint32_t> name_start, room_start;
+  string names, rooms;
+  append_names(instance.films, name_start, names);
+  append_names(instance.CinRooms, room_start, rooms);
+
+  // The solvers place the films in the order of restrictions, which the
+  // instance is read with
+  vector<uint32_t> degree(n_films), order(n_films), adjacency_start, adjacency;
+  for (int i = 0; i < n_films; ++i){
+    degree[instance.restrictions[i].first] = instance.restrictions[i].second;
+    order[i] = instance.restrictions[i].first;
+  }
+  for (int i = 0; i < n_films; ++i){
+    adjacency_start.push_back(adjacency.size());
+    for (int j = 0; j < n_films; ++j) if (instance.relations_graph[i][j]) adjacency.push_back(j);
+  }
+  adjacency_start.push_back(adjacency.size());
+
+  uint32_t header[8] = {COMPILED_MAGIC, COMPILED_VERSION, uint32_t(n_films),
+                        uint32_t(instance.n_PairsFilms), uint32_t(instance.n_CinRooms),
+                        uint32_t(names.size()), uint32_t(rooms.size()),
+                        uint32_t(adjacency.size())};
+  ofstream file(output_file, ios::binary);
+  if (not file){
+    cerr << "Cannot write " << output_file << endl;
+    exit(1);
+  }
+  file.write((const char*)header, sizeof(header));
+  file.write((const char*)name_start.data(), name_start.size()*sizeof(uint32_t));
+  file.write((const char*)room_start.data(), room_start.size()*sizeof(uint32_t));
+  file.write((const char*)degree.data(), degree.size()*sizeof(uint32_t));
+  file.write((const char*)order.data(), order.size()*sizeof(uint32_t));
+  file.write((const char*)adjacency_start.data(), adjacency_start.size()*sizeof(uint32_t));
+  file.write((const char*)adjacency.data(), adjacency.size()*sizeof(uint32_t));
+  file.write(names.data(), names.size());
+  file.write(rooms.data(), rooms.size());
+  file.close();
+  if (not file){
+    cerr << "Cannot write " << output_file << endl;
+    exit(1);
+  }
+}
+
+/* --------------------------------------------------------
+* Name: usage
+* Function: Explains how to call the program and exits.
+* Parameters: -
+* Return: -
+-------------------------------------------------------- */
+void usage(){
+  cerr << "Usage: compile INPUT OUTPUT" << endl;
+  exit(1);
+}
+
+/***********************************************************
+                          MAIN
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: main
+* Function: main function
+* Parameters: argc: number of arguments passed when
+              launching the code
+              argv: arguments given
+* Return: 0
+-------------------------------------------------------- */
+
+int main(int argc, char** argv){
+  if (argc != 3) usage();
+  // Set the intput and output files
+  input_file = string(argv[1]);
+  output_file = string(argv[2]);
+  // Read data from the text file
+  if (not read_data(input_file, instance)) exit(1);
+  // Write it in binary
+  write();
+}
@@ -0,0 +1,358 @@
+/*********************************************************
+File name: dec.cc
+File function: develop a schedule with the fewest possible
+days of screened films, taking into account the films that
+cannot be projected in the same time and the number of
+cinemas. It is an exact algorithm that answers, for a
+decreasing number of days k, whether the festival fits in
+k days; each question is solved by an exhaustive search
+with conflict-directed backjumping that records the
+partial schedules that failed (nogoods) and reuses them
+for every smaller k.
+**********************************************************/
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include <iostream>
+#include <vector>
+#include <ctime>
+#include <algorithm>
+#include <fstream>
+#include <utility>
+#include <cstdint>
+#include "greedy.h"
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+unsigned t0, t1; // Time variables
+string input_file, output_file; // Files to read input and write output
+
+Instance instance; // Instance being solved
+
+string renumbering = "none"; // Order of the film numbers: "none" keeps the
+// order of the input, "degree" or "rcm" (see renumber)
+
+int BestDays; // Will store the minimum days to organize the festival found
+Organization best; // Schedule with BestDays days
+
+const int MAX_NOGOOD_SIZE = 32; // Longer nogoods are not recorded
+const int MAX_NOGOODS = 1000000; // Nogoods recorded at most
+const int CLIQUE_SEEDS = 32; // Films from which cliques are grown
+
+int max_days; // Days of the first schedule; a literal (film, day) is
+// numbered film*max_days + day
+vector<int> order; // Films in the order they are placed: first a clique,
+// whose films get the days 0, 1, ..., then the rest by decreasing
+// restrictions
+int n_fixed; // Films of the clique
+vector<int> depth; // Position of each film in order
+vector<int> next_value; // Next day to try for the film of each depth
+int words; // 64-bit words of a set of depths
+vector<uint64_t> conflict_set; // For each depth, set of the earlier depths
+// whose days have ruled out the days tried so far
+vector<bool> forbidden; // Literals ruled out by a nogood of a single literal
+vector<int> nogood_start; // Where each nogood starts in nogood_literals;
+// its two first literals are the watched ones
+vector<int> nogood_literals; // Literals of every nogood
+vector<vector<int>> watches; // Nogoods watching each literal
+long nogoods_learned; // Nogoods recorded so far
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: write
+* Function: Writes the output on "output.txt" file (time
+            required, days the festival lasts and schedule).
+* Parameters: best: matrix with the best film schedule
+              where the rows are the days and the columns
+              are the cinema rooms.
+* Return: -
+-------------------------------------------------------- */
+void write(const Organization& best){
+  // Calculates the time it has taken to know the schedule
+  t1 = clock();
+  write_schedule(output_file, instance, best, double(t1-t0)/CLOCKS_PER_SEC);
+}
+
+/* --------------------------------------------------------
+* Name: find_clique
+* Function: Grows cliques of incompatible films greedily from
+            the films with most restrictions and keeps the
+            biggest one. Its films need a day each, so it
+            gives a lower bound and fixes their days.
+* Parameters: clique: Biggest clique found (output).
+* Return: -
+-------------------------------------------------------- */
+void find_clique(vector<int>& clique){
+  vector<int> candidate;
+  clique.clear();
+  for (int seed = 0; seed < min(instance.n_films, CLIQUE_SEEDS); ++seed){
+    candidate.assign(1, instance.restrictions[seed].first);
+    for (int i = 0; i < instance.n_films; ++i){
+      int code = instance.restrictions[i].first;
+      bool adjacent = true;
+      for (int k = 0; k < int(candidate.size()) and adjacent; ++k) adjacent = instance.relations_graph[code][candidate[k]];
+      if (adjacent) candidate.push_back(code);
+    }
+    if (candidate.size() > clique.size()) clique = candidate;
+  }
+}
+
+/* --------------------------------------------------------
+* Name: add_to_set / deepest
+* Function: Operations on the conflict sets: adding a depth
+            and finding the deepest depth of a set not in
+            the clique.
+* Parameters: set: Conflict set (its first word).
+              d: Depth.
+* Return: The deepest depth, or -1 if there is none.
+-------------------------------------------------------- */
+inline void add_to_set(uint64_t* set, int d){
+  set[d >> 6] |= uint64_t(1) << (d & 63);
+}
+
+int deepest(const uint64_t* set){
+  for (int w = words-1; w >= 0; --w){
+    if (set[w] != 0){
+      int d = w*64 + 63 - __builtin_clzll(set[w]);
+      return d >= n_fixed ? d : -1;
+    }
+  }
+  return -1;
+}
+
+/* --------------------------------------------------------
+* Name: violated_nogood
+* Function: Checks, after placing a film, whether a recorded
+            nogood has all its literals true. Only the
+            nogoods watching the new literal are visited; the
+            ones that still have another false literal start
+            watching it instead.
+* Parameters: actual: Schedule.
+              literal: Literal that has just become true.
+* Return: The violated nogood, or -1 if there is none.
+-------------------------------------------------------- */
+int violated_nogood(const Organization& actual, int literal){
+  vector<int>& watching = watches[literal];
+  for (int w = 0; w < int(watching.size()); ++w){
+    int nogood = watching[w];
+    int* literals = &nogood_literals[nogood_start[nogood]];
+    int size = nogood_start[nogood+1] - nogood_start[nogood];
+    // Keep the literal that has become true in the second position
+    if (literals[0] == literal) swap(literals[0], literals[1]);
+    bool moved = false;
+    for (int k = 2; k < size and not moved; ++k){
+      int film = literals[k]/max_days;
+      if (actual.film_day[film] != literals[k]%max_days){
+        // Watch this false literal instead
+        swap(literals[1], literals[k]);
+        watches[literals[1]].push_back(nogood);
+        watching[w] = watching.back();
+        watching.pop_back();
+        --w;
+        moved = true;
+      }
+    }
+    if (not moved and actual.film_day[literals[0]/max_days] == literals[0]%max_days) return nogood;
+  }
+  return -1;
+}
+
+/* --------------------------------------------------------
+* Name: learn
+* Function: Records the nogood given by a conflict set: the
+            current days of its films cannot be extended to
+            a schedule, neither with these days nor with
+            fewer. The two deepest literals are watched.
+* Parameters: actual: Schedule.
+              set: Conflict set.
+* Return: -
+-------------------------------------------------------- */
+void learn(const Organization& actual, const uint64_t* set){
+  int start = nogood_literals.size();
+  // From the deepest depth down, so the watched literals come first
+  for (int w = words-1; w >= 0; --w){
+    for (uint64_t bits = set[w]; bits != 0; ){
+      int bit = 63 - __builtin_clzll(bits);
+      bits &= ~(uint64_t(1) << bit);
+      int d = w*64 + bit;
+      // The days of the clique are fixed, so they are always true
+      if (d < n_fixed) continue;
+      int film = order[d];
+      nogood_literals.push_back(film*max_days + actual.film_day[film]);
+    }
+  }
+  int size = int(nogood_literals.size()) - start;
+  if (size == 1) forbidden[nogood_literals[start]] = true;
+  if (size <= 1 or size > MAX_NOGOOD_SIZE or nogoods_learned >= MAX_NOGOODS){
+    nogood_literals.resize(start);
+    return;
+  }
+  int nogood = int(nogood_start.size())-1;
+  nogood_start.push_back(nogood_literals.size());
+  watches[nogood_literals[start]].push_back(nogood);
+  watches[nogood_literals[start+1]].push_back(nogood);
+  ++nogoods_learned;
+}
+
+/* --------------------------------------------------------
+* Name: fits
+* Function: Decides whether the festival fits in k days: an
+            exhaustive search where each film, in order,
+            tries every day. The days ruled out for a film
+            add to its conflict set the depths responsible;
+            when every day is ruled out, the conflict set is
+            recorded as a nogood and the search jumps back to
+            its deepest depth instead of the previous one.
+            Empty days are interchangeable, so a film only
+            tries the first one: the days in use are always
+            the first ones, and whatever rules out the first
+            empty day rules out the others too.
+* Parameters: actual: Empty schedule, with the solution if
+              there is one.
+              k: Days available.
+* Return: True if a schedule with at most k days exists.
+-------------------------------------------------------- */
+bool fits(Organization& actual, int k){
+  // The clique films get the first days
+  for (int i = 0; i < n_fixed; ++i) place_film(actual, i, order[i]);
+  int i = n_fixed;
+  if (i < instance.n_films){
+    next_value[i] = 0;
+    fill(&conflict_set[i*words], &conflict_set[(i+1)*words], 0);
+  }
+  while (i < instance.n_films){
+    int code = order[i];
+    uint64_t* set = &conflict_set[i*words];
+    bool placed = false;
+    int last_day = min(k, actual.days+1);
+    for (int day = next_value[i]; day < last_day and not placed; ++day){
+      if (forbidden[code*max_days + day]) continue;
+      const int* day_films = &actual.schedule[day*instance.n_CinRooms];
+      // A full day is ruled out by every film on it
+      if (actual.filled[day] == instance.n_CinRooms){
+        for (int room = 0; room < instance.n_CinRooms; ++room) add_to_set(set, depth[day_films[room]]);
+        continue;
+      }
+      // An incompatible film rules the day out; blame the earliest one
+      int culprit = instance.n_films;
+      for (int room = 0; room < actual.filled[day]; ++room){
+        if (instance.relations_graph[code][day_films[room]]) culprit = min(culprit, depth[day_films[room]]);
+      }
+      if (culprit < instance.n_films){
+        add_to_set(set, culprit);
+        continue;
+      }
+      place_film(actual, day, code);
+      int nogood = violated_nogood(actual, code*max_days + day);
+      if (nogood >= 0){
+        // The other films of the nogood rule the day out
+        for (int l = nogood_start[nogood]; l < nogood_start[nogood+1]; ++l){
+          int film = nogood_literals[l]/max_days;
+          if (film != code) add_to_set(set, depth[film]);
+        }
+        remove_last_film(actual, day);
+        continue;
+      }
+      next_value[i] = day+1;
+      placed = true;
+    }
+    if (placed){
+      ++i;
+      if (i < instance.n_films){
+        next_value[i] = 0;
+        fill(&conflict_set[i*words], &conflict_set[(i+1)*words], 0);
+      }
+      continue;
+    }
+    // Every day is ruled out: learn why and jump back
+    learn(actual, set);
+    int h = deepest(set);
+    if (h < 0) return false;
+    uint64_t* back = &conflict_set[h*words];
+    for (int w = 0; w < words; ++w) back[w] |= set[w];
+    back[h >> 6] &= ~(uint64_t(1) << (h & 63));
+    for (int j = i-1; j >= h; --j) remove_last_film(actual, actual.film_day[order[j]]);
+    i = h;
+  }
+  return true;
+}
+
+/***********************************************************
+                          MAIN
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: main
+* Function: main function
+* Parameters: argc: number of arguments passed when
+              launching the code
+              argv: arguments given
+* Return: 0
+-------------------------------------------------------- */
+
+int main(int argc, char** argv){
+  // Read the options: --renumber=ORDER gives the films new numbers
+  vector<string> arguments;
+  for (int i = 1; i < argc; ++i){
+    string argument = argv[i];
+    if (argument.compare(0, 11, "--renumber=") == 0) renumbering = argument.substr(11);
+    else arguments.push_back(argument);
+  }
+  // Set the intput and output files
+  input_file = arguments[0];
+  output_file = arguments[1];
+  // Read data from the file
+  if (not read_data(input_file, instance)) exit(1);
+  // Optionally, give incompatible films close numbers
+  if (not renumber(instance, renumbering)) exit(1);
+  // Start counting time
+  t0 = clock();
+  // The greedy schedule is the first upper bound
+  init_organization(best, instance);
+  greedy(instance, best);
+  BestDays = best.days;
+  write(best);
+
+  // A clique fixes the first days and, with the cinema rooms, gives a
+  // lower bound
+  vector<int> clique;
+  find_clique(clique);
+  n_fixed = clique.size();
+  int lower_bound = max(n_fixed, instance.n_CinRooms > 0 ? (instance.n_films + instance.n_CinRooms - 1)/instance.n_CinRooms : 0);
+  vector<bool> in_clique(instance.n_films, false);
+  for (int i = 0; i < n_fixed; ++i){
+    order.push_back(clique[i]);
+    in_clique[clique[i]] = true;
+  }
+  for (int i = 0; i < instance.n_films; ++i) if (not in_clique[instance.restrictions[i].first]) order.push_back(instance.restrictions[i].first);
+  depth.resize(instance.n_films);
+  for (int i = 0; i < instance.n_films; ++i) depth[order[i]] = i;
+
+  max_days = max(1, BestDays);
+  words = (instance.n_films + 63)/64;
+  next_value.assign(instance.n_films, 0);
+  conflict_set.assign(instance.n_films*words, 0);
+  forbidden.assign(instance.n_films*max_days, false);
+  watches.resize(instance.n_films*max_days);
+  nogood_start.assign(1, 0);
+  nogoods_learned = 0;
+
+  // Ask for one day less than the best schedule until it does not fit; the
+  // nogoods learned with k days also hold with fewer
+  Organization actual;
+  init_organization(actual, instance);
+  while (BestDays > lower_bound){
+    clear_organization(actual);
+    if (not fits(actual, BestDays-1)) break;
+    best = actual;
+    BestDays = best.days;
+    write(best);
+  }
+}
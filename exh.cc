@@ -16,111 +16,128 @@ Date: 07_12_2021
 #include <iostream>
 #include <vector>
 #include <ctime>
-#include <map>
 #include <algorithm>
 #include <fstream>
-
-using namespace std;
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cstdint>
+#include "exh.h"
 
 /***********************************************************
                  CONSTANTS AND VARIABLES
 ***********************************************************/
 
-unsigned t0, t1; // Time variables
+clock_t t0, t1; // Time variables (t0 goes below 0 when a run is resumed)
 string input_file, output_file; // Files to read input and write output
 
-int n_films; // |P|: Films number
-int n_PairsFilms; // |L|: Pair of films that cannot be projected together
-int n_CinRooms; // |S|: Cinema rooms number
-
-vector<string> films; // Vector with film names
-vector<string> CinRooms; // Vector with cinema rooms names
+Instance instance; // Instance being solved
 
-map<string, int> film_code; // Map that assigns a film to a number
+string renumbering = "none"; // Order of the film numbers: "none" keeps the
+// order of the input, "degree" or "rcm" (see renumber)
 
-vector<vector<bool>> relations_graph; // Boolean matrix that
-// indicates if a film can be projected with another one or not
+Exhaustive exhaustive; // State of the search (see exh.h)
 
-using Organization = vector<vector<int>>; // Matrix with the festival
-// organization; each row is a day and each column is a cinema room
-using Pair = pair<int,int>; // Releates a film with the total incompatibilities
-// it has
+const int CHECKPOINT_VERSION = 1; // Version of the checkpoint files
+string checkpoint_file; // Where the search is saved and resumed from
+double checkpoint_every; // Seconds between checkpoints (0 to never save it)
+clock_t next_checkpoint; // When the next checkpoint is due
 
-vector<Pair> restrictions; // Vector that stores with how many films a film
-// cannot be projected
-
-int BestDays; // Will store the minimum days to organize the festival found
+int stream_fd = -1; // Descriptor where the improving solutions are streamed
+// (-1 if they are only written on the output file)
+vector<int> streamed_day, streamed_room; // Day and cinema room of each film
+// on the last streamed solution
+vector<int> stream_record; // Buffer where each streamed record is built
 
 /***********************************************************
                         FUNCTIONS
 ***********************************************************/
 
 /* --------------------------------------------------------
-* Name: comparator
-* Function: Compares two Pair struct to determine which one
-            it is bigger.
-* Parameters: a and b: two Pair struct.
-* Return: the Pair with the second biggest field.
+* Name: open_stream
+* Function: Opens the channel where every improving solution
+            is streamed as soon as it is found: "-" is the
+            standard output, "unix:<path>" a local Unix
+            socket and any other name a file or a FIFO.
+* Parameters: target: Where to stream the solutions.
+* Return: -
 -------------------------------------------------------- */
-bool comparator (const Pair& a, const Pair& b){
-  return a.second > b.second;
+void open_stream(const string& target){
+  // A reader that goes away must not kill the search
+  signal(SIGPIPE, SIG_IGN);
+  if (target == "-") stream_fd = STDOUT_FILENO;
+  else if (target.compare(0, 5, "unix:") == 0){
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, target.c_str()+5, sizeof(address.sun_path)-1);
+    stream_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (stream_fd >= 0 and connect(stream_fd, (sockaddr*)&address, sizeof(address)) < 0){
+      close(stream_fd);
+      stream_fd = -1;
+    }
+  }
+  // Opening a FIFO waits until there is someone reading it
+  else stream_fd = open(target.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (stream_fd < 0) cerr << "Cannot stream solutions to " << target << endl;
+  // Nothing has been streamed yet, so the first record has every film
+  streamed_day.assign(instance.n_films, -1);
+  streamed_room.assign(instance.n_films, -1);
+  stream_record.reserve(2 + 3 + 3*instance.n_films);
 }
 
 /* --------------------------------------------------------
-* Name: read_data
-* Function: Reads the input from a file and process it.
-* Parameters: file: Name of the file from where we want to
-             get the input.
+* Name: stream_solution
+* Function: Sends an improving solution through the stream
+            as a length-prefixed record of 32-bit words in
+            host byte order: the length in bytes of what
+            follows, the days, the elapsed time (a double),
+            the number of films that changed with respect
+            to the previous record and, for each of them,
+            its number, day and cinema room.
+* Parameters: best: Schedule found.
+              days: Days the festival lasts.
+              time: Seconds it has taken to find it.
 * Return: -
 -------------------------------------------------------- */
-void read_data(){
-  // Performing the input of a file
-  ifstream in(input_file);
-
-  in >> n_films;
-  films.resize(n_films);
-  restrictions.resize(n_films);
-  string name;
-  for (int i = 0; i < n_films; ++i){
-    // Reads the film name
-    in >> name;
-    // Assigning the film to a number
-    film_code.insert({name, i});
-    // Saves the film names
-    films[i] = name;
-    // Initializes with 0 films that cannot be projected
-    restrictions[film_code[name]].first = film_code[name];
-    restrictions[film_code[name]].second = 0;
+void stream_solution(const Organization& best, int days, double time){
+  if (stream_fd < 0) return;
+  // Leave room for the length, which is known at the end
+  stream_record.assign(1, 0);
+  stream_record.push_back(days);
+  int time_words[2];
+  memcpy(time_words, &time, sizeof(time));
+  stream_record.push_back(time_words[0]);
+  stream_record.push_back(time_words[1]);
+  stream_record.push_back(0);
+  for (int code = 0; code < instance.n_films; ++code){
+    if (best.film_day[code] != streamed_day[code] or best.film_room[code] != streamed_room[code]){
+      streamed_day[code] = best.film_day[code];
+      streamed_room[code] = best.film_room[code];
+      stream_record.push_back(instance.original_code[code]);
+      stream_record.push_back(streamed_day[code]);
+      stream_record.push_back(streamed_room[code]);
+    }
   }
-
-  // Reading films that can not been projected at the same time
-  in >> n_PairsFilms;
-  // At the beginning there are not incompatibilities
-  relations_graph.resize(n_films, vector<bool> (n_films, false));
-  string film1, film2;
-  for (int i = 0; i < n_PairsFilms; ++i){
-    // Reads the films names
-    in >> film1 >> film2;
-    int code1 = film_code[film1];
-    int code2 = film_code[film2];
-    // Increases the number of restrictions each film has
-    restrictions[code1].second += 1;
-    restrictions[code2].second += 1;
-    // Marks the boxes corresponding to the two films as true, indicating
-    // there is an incompatibility
-    relations_graph[code1][code2] = true;
-    relations_graph[code2][code1] = true;
+  stream_record[4] = (int(stream_record.size())-5)/3;
+  stream_record[0] = (int(stream_record.size())-1)*sizeof(int);
+  // Send the whole record, even if the channel takes it in pieces
+  const char* data = (const char*)stream_record.data();
+  size_t pending = stream_record.size()*sizeof(int);
+  while (pending > 0){
+    ssize_t sent = ::write(stream_fd, data, pending);
+    if (sent <= 0){
+      // The reader has gone: keep solving without streaming
+      if (stream_fd != STDOUT_FILENO) close(stream_fd);
+      stream_fd = -1;
+      return;
+    }
+    data += sent;
+    pending -= sent;
   }
-
-  // Sorting films by restrictions
-  sort(restrictions.begin(), restrictions.end(), comparator);
-
-  // Reading cinema rooms
-  in >> n_CinRooms;
-  CinRooms.resize(n_CinRooms);
-  // Saves the cinema names
-  for (int i = 0; i < n_CinRooms; ++i) in >> CinRooms[i];
-
 }
 
 /* --------------------------------------------------------
@@ -136,85 +153,116 @@ void write(const Organization& best){
   // Calculates the time it has taken to know the schedule
   t1 = clock();
   double time = (double(t1-t0)/CLOCKS_PER_SEC);
-  // Performing the output of a file
-  ofstream file;
-  // Set decimal precision with 1 decimal
-  file.setf(ios::fixed);
-  file.precision(1);
-  // Creating or opening the file where we will write the output
-  file.open(output_file);
-  // Writes the time it has taken to compute the solution
-  file << time << endl;
-  // Writes how many days the festival lasts
-  file << BestDays << endl;
-  // For each film writes on which day it will be performed and
-  // at which cinema room
-  for (int i = 0; i < BestDays; ++i){
-    for (int j = 0; j < int(best[i].size()); ++j){
-      file << films[best[i][j]] << " " << i+1 << " " << CinRooms[j] << endl;
-    }
-  }
+  write_schedule(output_file, instance, best, time);
+  // Let whoever is monitoring the search know about it
+  stream_solution(best, best.days, time);
+}
+
+/* --------------------------------------------------------
+* Name: save_checkpoint
+* Function: Writes the state of the search on the checkpoint
+            file: the best days found, the path of days
+            chosen for the films placed and, for each of
+            them, the next day to try (the frontier of the
+            subtrees left). It is written on a temporary
+            file and renamed, so a checkpoint is never left
+            half-written.
+* Parameters: -
+* Return: -
+-------------------------------------------------------- */
+void save_checkpoint(){
+  string temporary = checkpoint_file + ".tmp";
+  ofstream file(temporary);
+  file << "exh " << CHECKPOINT_VERSION << endl;
+  file << instance.n_films << " " << instance.n_PairsFilms << " " << instance.n_CinRooms << endl;
+  file << exhaustive.best_days << " " << double(clock()-t0)/CLOCKS_PER_SEC << endl;
+  file << exhaustive.film_index << endl;
+  for (int i = 0; i < exhaustive.film_index; ++i) file << exhaustive.placed_day[i] << " ";
+  file << endl;
+  for (int i = 0; i <= exhaustive.film_index; ++i) file << exhaustive.next_choice[i] << " ";
+  file << endl;
   file.close();
+  rename(temporary.c_str(), checkpoint_file.c_str());
 }
 
 /* --------------------------------------------------------
-* Name: can_be_projected
-* Function: Indicates if a film can be projected on a
-            given a day depending on if it is incompatible
-            with the thers films of that day or not.
-* Parameters: actual: Matrix with the schedule (rows are
-              the days and, the columns, the cinema rooms).
-              day: The day we want to check.
-              code: Film number.
-* Return: True if a film can be projected that day or
-          false otherwise.
+* Name: load_checkpoint
+* Function: Restores the state of the search saved by
+            save_checkpoint, placing again the films of the
+            path.
+* Parameters: actual: Empty schedule where the path is placed.
+* Return: -
 -------------------------------------------------------- */
-bool can_be_projected(const Organization& actual, int day, int code){
-  for (int i = 0; i < int(actual[day].size()); ++i) if (relations_graph[actual[day][i]][code]) return false;
-  return true;
+void load_checkpoint(Organization& actual){
+  ifstream file(checkpoint_file);
+  string kind;
+  int version, films_number, pairs_number, rooms_number;
+  file >> kind >> version >> films_number >> pairs_number >> rooms_number;
+  if (not file or kind != "exh" or version != CHECKPOINT_VERSION or films_number != instance.n_films
+      or pairs_number != instance.n_PairsFilms or rooms_number != instance.n_CinRooms){
+    cerr << "Cannot resume from " << checkpoint_file << endl;
+    exit(1);
+  }
+  double time;
+  int film_index;
+  file >> exhaustive.best_days >> time >> film_index;
+  bool valid = file and exhaustive.best_days > 0 and exhaustive.best_days <= instance.n_films and time >= 0
+               and film_index >= 0 and film_index <= instance.n_films;
+  vector<int>& placed_day = exhaustive.placed_day;
+  vector<int>& next_choice = exhaustive.next_choice;
+  // Place again the films of the path, checking that each one goes to a day
+  // with room and no incompatible film, as the search left them
+  for (int i = 0; valid and i < film_index; ++i){
+    int code = instance.restrictions[i].first;
+    file >> placed_day[i];
+    valid = file and placed_day[i] >= 0 and placed_day[i] <= actual.days;
+    if (valid and placed_day[i] < actual.days)
+      valid = actual.filled[placed_day[i]] < instance.n_CinRooms and can_be_projected<0>(instance, actual, placed_day[i], code);
+    if (valid) place_film(actual, placed_day[i], code);
+  }
+  // The films of the path go on from the day after the one they are on
+  for (int i = 0; valid and i <= film_index; ++i){
+    file >> next_choice[i];
+    if (i < film_index) valid = file and next_choice[i] == placed_day[i]+1;
+    else valid = file and next_choice[i] >= 0 and next_choice[i] <= actual.days+1;
+  }
+  if (not valid){
+    cerr << "Cannot resume from " << checkpoint_file << endl;
+    exit(1);
+  }
+  exhaustive.film_index = film_index;
+  // Keep counting the time from where the previous run stopped
+  t0 = clock() - clock_t(time*CLOCKS_PER_SEC);
 }
 
 /* --------------------------------------------------------
-* Name: schedule_festival
-* Function: Schedule films in a matrix of days and cinemas,
-            respecting the films that cannot be projected
-            at the same time.
-* Parameters: best: Matrix with the best schedule (rows
-              are the days and the columns the cinemas).
-              actual: Matrix with the current schedule
-              (rows are the days and the columns the
-              cinemas).
-              BestDays: Number of days of the best schedule.
-              ActualDays: Number of days of the current
-              schedule.
-              film_index: Film position.
+* Name: found
+* Function: Called by the search with every schedule that
+            improves the best one: writes it.
+* Parameters: search: Search.
+              best: Schedule found.
 * Return: -
 -------------------------------------------------------- */
-void schedule_festival(Organization& actual, int ActualDays, int film_index){
-  // If the minimum days found is lower than the days found at the moment
-  // then we prune
-  if (ActualDays < BestDays){
-    // We finish if all the films are placed
-    if (film_index == n_films){
-      BestDays = ActualDays;
-      write(actual);
-    } else{
-      // Go through the days that have been initialized
-      for (int i = 0; i <  int(actual.size()); ++i){
-        // If there is enough space on that day and there are not incompatibilities, then place the film
-        if (int(actual[i].size()) < n_CinRooms and can_be_projected(actual, i, restrictions[film_index].first)) {
-          actual[i].push_back(restrictions[film_index].first);
-          // Let's place the following film
-          schedule_festival(actual, ActualDays, film_index+1);
-          actual[i].pop_back();
-        }
-      }
-      // If the film has not been placed on any day it will be placed on a new day
-      actual.push_back({restrictions[film_index].first});
-      schedule_festival(actual, ActualDays+1, film_index+1);
-      actual.pop_back();
-    }
+void found(Search& search, const Organization& best){
+  write(best);
+}
+
+/* --------------------------------------------------------
+* Name: interrupted
+* Function: Called by the search from time to time: saves
+            it when a checkpoint is due. The search is never
+            stopped.
+* Parameters: search: Search.
+* Return: false.
+-------------------------------------------------------- */
+bool interrupted(Search& search){
+  clock_t now = clock();
+  search.elapsed = double(now-t0)/CLOCKS_PER_SEC;
+  if (checkpoint_every > 0 and now >= next_checkpoint){
+    save_checkpoint();
+    next_checkpoint = clock() + checkpoint_every*CLOCKS_PER_SEC;
   }
+  return false;
 }
 
 /***********************************************************
@@ -231,17 +279,45 @@ void schedule_festival(Organization& actual, int ActualDays, int film_index){
 -------------------------------------------------------- */
 
 int main(int argc, char** argv){
+  // Read the options: --resume continues from the last checkpoint,
+  // --checkpoint-every=SECONDS sets how often it is written (0 never) and
+  // --renumber=ORDER gives the films new numbers
+  bool resume = false;
+  checkpoint_every = 60;
+  vector<string> arguments;
+  for (int i = 1; i < argc; ++i){
+    string argument = argv[i];
+    if (argument == "--resume") resume = true;
+    else if (argument.compare(0, 19, "--checkpoint-every=") == 0) checkpoint_every = atof(argument.c_str()+19);
+    else if (argument.compare(0, 11, "--renumber=") == 0) renumbering = argument.substr(11);
+    else arguments.push_back(argument);
+  }
   // Set the intput and output files
-  input_file = string(argv[1]);
-  output_file = string(argv[2]);
+  input_file = arguments[0];
+  output_file = arguments[1];
+  checkpoint_file = output_file + ".checkpoint";
   // Read data from the file
-  read_data();
-  // Create the schedule
+  if (not read_data(input_file, instance)) exit(1);
+  // Optionally, give incompatible films close numbers
+  if (not renumber(instance, renumbering)) exit(1);
+  // Optionally, stream every improving solution
+  if (arguments.size() > 2) open_stream(arguments[2]);
+  // Create the schedule, with all its memory reserved beforehand
   Organization actual;
+  init_organization(actual, instance);
+  init_exhaustive(exhaustive, instance);
+  exhaustive.found = found;
+  exhaustive.interrupted = interrupted;
+  exhaustive.time_limit = 0;
+  exhaustive.elapsed = 0;
+  exhaustive.data = nullptr;
   // In the worst case, there will be as many days as films
-  BestDays = n_films;
+  exhaustive.best_days = instance.n_films;
   // Start counting time
   t0 = clock();
-  // Schedule the festival
-  schedule_festival(actual, 0, 0);
+  // Schedule the festival, starting again where it was left if we resume
+  if (resume) load_checkpoint(actual);
+  next_checkpoint = clock() + checkpoint_every*CLOCKS_PER_SEC;
+  // The search is complete, there is nothing to resume
+  if (schedule_festival(exhaustive, actual)) remove(checkpoint_file.c_str());
 }
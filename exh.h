@@ -0,0 +1,139 @@
+/*********************************************************
+File name: exh.h
+File function: the exhaustive search of exh.cc, which
+explores every schedule whose days go below the best one
+found. Its stack is kept explicitly so that the program
+running it can save it and resume it later.
+**********************************************************/
+
+#ifndef EXH_H
+#define EXH_H
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include "schedule.h"
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+struct Exhaustive : Search {
+  int film_index; // Films placed on the path being explored
+  vector<int> placed_day; // Day on which each film of the path is placed
+  vector<int> next_choice; // Next day each film of the path will try
+  long nodes; // Nodes explored
+};
+
+const int INTERRUPTION_STEPS = 4096; // Nodes explored between two calls to
+// interrupted
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: init_exhaustive
+* Function: Prepares an exhaustive search whose path is
+            empty.
+* Parameters: search: Search to prepare.
+              instance: Instance to solve.
+* Return: -
+-------------------------------------------------------- */
+inline void init_exhaustive(Exhaustive& search, const Instance& instance){
+  search.instance = &instance;
+  search.film_index = 0;
+  search.placed_day.assign(instance.n_films, -1);
+  search.next_choice.assign(instance.n_films+1, 0);
+  search.nodes = 0;
+}
+
+/* --------------------------------------------------------
+* Name: schedule_festival
+* Function: Schedule films in a matrix of days and cinemas,
+            respecting the films that cannot be projected
+            at the same time. The depth-first search keeps
+            its stack explicitly (placed_day and
+            next_choice), so that it can be checkpointed
+            and resumed at any moment. It is specialized for
+            each small number of cinema rooms (ROOMS), or
+            generic when ROOMS is 0.
+* Parameters: search: Search, with the films of actual as
+              its path.
+              actual: Matrix with the current schedule
+              (rows are the days and the columns the
+              cinemas).
+* Return: True if every schedule has been explored, false
+          if the search was interrupted.
+-------------------------------------------------------- */
+template <int ROOMS>
+bool schedule_festival(Exhaustive& search, Organization& actual){
+  const Instance& instance = *search.instance;
+  int n_films = instance.n_films;
+  int film_index = search.film_index;
+  while (film_index >= 0){
+    // Let the program save the search or stop it from time to time
+    if (++search.nodes % INTERRUPTION_STEPS == 0){
+      search.film_index = film_index;
+      if (search.interrupted(search)) return false;
+    }
+    // If the minimum days found is lower than the days found at the moment
+    // then we go on; otherwise, we prune
+    bool go_on = actual.days < search.best_days;
+    // We finish if all the films are placed
+    if (go_on and film_index == n_films){
+      search.best_days = actual.days;
+      search.found(search, actual);
+      go_on = false;
+    }
+    if (go_on){
+      int code = instance.restrictions[film_index].first;
+      // Look for the next day, from the ones that have been initialized, with
+      // enough space and no incompatibilities; the day after the last one
+      // is a new day
+      int day = search.next_choice[film_index];
+      while (day < actual.days and not (actual.filled[day] < room_count<ROOMS>(actual) and can_be_projected<ROOMS>(instance, actual, day, code))) ++day;
+      if (day <= actual.days){
+        // Place the film there and go to the following film
+        search.next_choice[film_index] = day+1;
+        place_film(actual, day, code);
+        search.placed_day[film_index] = day;
+        ++film_index;
+        search.next_choice[film_index] = 0;
+        continue;
+      }
+    }
+    // Every option of this film has been tried: go back to the previous one
+    --film_index;
+    if (film_index >= 0) remove_last_film(actual, search.placed_day[film_index]);
+  }
+  search.film_index = film_index;
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: schedule_festival
+* Function: Runs the exhaustive search with the kernel
+            specialized for the number of cinema rooms, if
+            there is one.
+* Parameters: search: Search, with the films of actual as
+              its path.
+              actual: Matrix with the current schedule.
+* Return: True if every schedule has been explored, false
+          if the search was interrupted.
+-------------------------------------------------------- */
+inline bool schedule_festival(Exhaustive& search, Organization& actual){
+  switch (search.instance->n_CinRooms){
+    case 2: return schedule_festival<2>(search, actual);
+    case 3: return schedule_festival<3>(search, actual);
+    case 4: return schedule_festival<4>(search, actual);
+    case 5: return schedule_festival<5>(search, actual);
+    case 6: return schedule_festival<6>(search, actual);
+    case 7: return schedule_festival<7>(search, actual);
+    case MAX_SPECIALIZED_ROOMS: return schedule_festival<MAX_SPECIALIZED_ROOMS>(search, actual);
+    default: return schedule_festival<0>(search, actual);
+  }
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*********************************************************
+File name: greedy.h
+File function: the greedy algorithm of greedy.cc, which
+places each film, by decreasing restrictions, on the first
+day it can be projected. It also gives the first schedule
+of the other solvers.
+**********************************************************/
+
+#ifndef GREEDY_H
+#define GREEDY_H
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include "schedule.h"
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: greedy
+* Function: Schedule films in a matrix of days and cinemas,
+            respecting the films that cannot be projected
+            at the same time: each film, by decreasing
+            restrictions, goes to the first day with a free
+            cinema room and no incompatible film, or to a
+            new day. It is specialized for each small number
+            of cinema rooms (ROOMS), or generic when ROOMS
+            is 0.
+* Parameters: instance: Instance to schedule.
+              actual: Empty schedule to fill.
+* Return: -
+-------------------------------------------------------- */
+template <int ROOMS>
+void greedy(const Instance& instance, Organization& actual){
+  // Go through the films
+  for (int film_index = 0; film_index < instance.n_films; ++film_index){
+    int code = instance.restrictions[film_index].first;
+    // projected will keep track of the film to decide if it has been placed
+    bool projected = false;
+    // Go through the days if the film has not been projected yet
+    for (int day = 0; day < actual.days and not projected; ++day){
+      // If the day has enough space and there are not incompatibilities, then we place the film
+      if (actual.filled[day] < room_count<ROOMS>(actual) and can_be_projected<ROOMS>(instance, actual, day, code)){
+        place_film(actual, day, code);
+        projected = true;
+      }
+    }
+    // If the place has not been placed, then place it in a new day
+    if (not projected) place_film(actual, actual.days, code);
+  }
+}
+
+/* --------------------------------------------------------
+* Name: greedy
+* Function: Runs the greedy algorithm with the kernel
+            specialized for the number of cinema rooms, if
+            there is one.
+* Parameters: instance: Instance to schedule.
+              actual: Empty schedule to fill.
+* Return: -
+-------------------------------------------------------- */
+inline void greedy(const Instance& instance, Organization& actual){
+  switch (instance.n_CinRooms){
+    case 2: greedy<2>(instance, actual); break;
+    case 3: greedy<3>(instance, actual); break;
+    case 4: greedy<4>(instance, actual); break;
+    case 5: greedy<5>(instance, actual); break;
+    case 6: greedy<6>(instance, actual); break;
+    case 7: greedy<7>(instance, actual); break;
+    case MAX_SPECIALIZED_ROOMS: greedy<MAX_SPECIALIZED_ROOMS>(instance, actual); break;
+    default: greedy<0>(instance, actual);
+  }
+}
+
+#endif
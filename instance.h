@@ -0,0 +1,343 @@
+/*********************************************************
+File name: instance.h
+File function: read a festival instance (the films, the
+films that cannot be projected in the same time and the
+cinema rooms), either from the text format or from the
+binary format written by compile.cc, which is checked
+before it is used, and optionally give its films new
+numbers. It is shared by every program.
+**********************************************************/
+
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <utility>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+const uint32_t COMPILED_MAGIC = 0x4d4c4946; // First word of the instances
+// translated to binary by compile.cc ("FILM" read as a word)
+const uint32_t COMPILED_VERSION = 1; // Version of their layout
+
+using Pair = pair<int,int>; // Releates a film with the total incompatibilities
+// it has
+
+struct Instance {
+  int n_films; // |P|: Films number
+  int n_PairsFilms; // |L|: Pair of films that cannot be projected together
+  int n_CinRooms; // |S|: Cinema rooms number
+  vector<string> films; // Vector with film names
+  vector<string> CinRooms; // Vector with cinema rooms names
+  vector<vector<bool>> relations_graph; // Boolean matrix that indicates if a
+  // film can be projected with another one or not
+  vector<Pair> restrictions; // Films sorted by how many films they cannot
+  // be projected with
+  vector<int> original_code; // Number each film had on the input (see
+  // renumber)
+};
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: comparator
+* Function: Compares two Pair struct to determine which one
+            it is bigger.
+* Parameters: a and b: two Pair struct.
+* Return: the Pair with the second biggest field.
+-------------------------------------------------------- */
+inline bool comparator (const Pair& a, const Pair& b){
+  return a.second > b.second;
+}
+
+/* --------------------------------------------------------
+* Name: bad_input
+* Function: Explains why an input file cannot be read.
+* Parameters: file: Name of the input file.
+              reason: What is wrong with it.
+* Return: false, so that the readers can return it.
+-------------------------------------------------------- */
+inline bool bad_input(const string& file, const string& reason){
+  cerr << file << " " << reason << endl;
+  return false;
+}
+
+/* --------------------------------------------------------
+* Name: valid_compiled
+* Function: Checks that a binary instance is consistent
+            before reading it: the file has exactly the size
+            its header gives, there is some cinema room, the
+            names and incompatibility lists start in order
+            inside their sections and every film number
+            stored is a valid one.
+* Parameters: word: Words of the file.
+              size: Size of the file in bytes.
+* Return: True if the instance can be read.
+-------------------------------------------------------- */
+inline bool valid_compiled(const uint32_t* word, off_t size){
+  uint64_t films_number = word[2], rooms_number = word[4];
+  uint64_t names_size = word[5], rooms_size = word[6], adjacency_size = word[7];
+  if (rooms_number == 0 or films_number > INT32_MAX or rooms_number > INT32_MAX) return false;
+  // Header, name_start, room_start, degree, order, adjacency_start and
+  // adjacency, followed by the names
+  uint64_t words = 8 + (films_number+1) + (rooms_number+1) + 2*films_number + (films_number+1) + adjacency_size;
+  if (uint64_t(size) != words*sizeof(uint32_t) + names_size + rooms_size) return false;
+  const uint32_t* name_start = word + 8;
+  const uint32_t* room_start = name_start + films_number + 1;
+  const uint32_t* order = room_start + rooms_number + 1 + films_number;
+  const uint32_t* adjacency_start = order + films_number;
+  const uint32_t* adjacency = adjacency_start + films_number + 1;
+  for (uint64_t i = 0; i < films_number; ++i){
+    if (name_start[i] > name_start[i+1] or adjacency_start[i] > adjacency_start[i+1] or order[i] >= films_number) return false;
+  }
+  if (name_start[films_number] > names_size or adjacency_start[films_number] > adjacency_size) return false;
+  for (uint64_t i = 0; i < rooms_number; ++i) if (room_start[i] > room_start[i+1]) return false;
+  if (room_start[rooms_number] > rooms_size) return false;
+  for (uint64_t k = 0; k < adjacency_size; ++k) if (adjacency[k] >= films_number) return false;
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: read_compiled
+* Function: Loads an instance translated to binary by
+            compile.cc, memory-mapping it instead of parsing
+            it.
+* Parameters: file: Name of the file.
+              instance: Where to load it.
+              compiled: Set to whether the file is binary
+              (output).
+* Return: True if the file was a valid binary instance.
+-------------------------------------------------------- */
+inline bool read_compiled(const string& file, Instance& instance, bool& compiled){
+  compiled = false;
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat info;
+  if (fstat(fd, &info) < 0 or info.st_size < off_t(8*sizeof(uint32_t))){
+    close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return false;
+  const uint32_t* word = (const uint32_t*)mapping;
+  if (word[0] != COMPILED_MAGIC){
+    munmap(mapping, info.st_size);
+    return false;
+  }
+  // From here on, the file is binary and will not be read as text
+  compiled = true;
+  if (word[1] != COMPILED_VERSION){
+    munmap(mapping, info.st_size);
+    return bad_input(file, "was compiled with another version of compile.cc");
+  }
+  if (not valid_compiled(word, info.st_size)){
+    munmap(mapping, info.st_size);
+    return bad_input(file, "is not a valid compiled instance");
+  }
+  int n_films = instance.n_films = word[2];
+  instance.n_PairsFilms = word[3];
+  int n_CinRooms = instance.n_CinRooms = word[4];
+  uint32_t names_size = word[5];
+  uint32_t adjacency_size = word[7];
+  // Locate each section of the file (see compile.cc)
+  const uint32_t* name_start = word + 8;
+  const uint32_t* room_start = name_start + n_films + 1;
+  const uint32_t* degree = room_start + n_CinRooms + 1;
+  const uint32_t* order = degree + n_films;
+  const uint32_t* adjacency_start = order + n_films;
+  const uint32_t* adjacency = adjacency_start + n_films + 1;
+  const char* names = (const char*)(adjacency + adjacency_size);
+  const char* rooms = names + names_size;
+
+  instance.films.resize(n_films);
+  for (int i = 0; i < n_films; ++i) instance.films[i].assign(names + name_start[i], name_start[i+1] - name_start[i]);
+  instance.CinRooms.resize(n_CinRooms);
+  for (int i = 0; i < n_CinRooms; ++i) instance.CinRooms[i].assign(rooms + room_start[i], room_start[i+1] - room_start[i]);
+  // The films are already sorted by restrictions
+  instance.restrictions.resize(n_films);
+  for (int i = 0; i < n_films; ++i) instance.restrictions[i] = Pair(order[i], degree[order[i]]);
+  instance.relations_graph.assign(n_films, vector<bool> (n_films, false));
+  for (int i = 0; i < n_films; ++i){
+    for (uint32_t k = adjacency_start[i]; k < adjacency_start[i+1]; ++k) instance.relations_graph[i][adjacency[k]] = true;
+  }
+  munmap(mapping, info.st_size);
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: read_data
+* Function: Reads an instance from a file and process it.
+            Binary instances are memory-mapped; text ones are
+            parsed, checking every read. The reason why a
+            file cannot be read is written on the error
+            output.
+* Parameters: file: Name of the file from where we want to
+              get the input.
+              instance: Where to load it.
+* Return: True if the instance could be read.
+-------------------------------------------------------- */
+inline bool read_data(const string& file, Instance& instance){
+  // Binary instances are memory-mapped instead of parsed
+  bool compiled;
+  if (read_compiled(file, instance, compiled)) return true;
+  if (compiled) return false;
+  // Performing the input of a file
+  ifstream in(file);
+  if (not in) return bad_input(file, "cannot be opened");
+
+  int& n_films = instance.n_films;
+  in >> n_films;
+  if (not in or n_films < 0) return bad_input(file, "does not start with the number of films");
+  instance.films.resize(n_films);
+  instance.restrictions.resize(n_films);
+  map<string, int> film_code;
+  string name;
+  for (int i = 0; i < n_films; ++i){
+    // Reads the film name
+    in >> name;
+    if (not in) return bad_input(file, "has fewer films than it says");
+    // Assigning the film to a number
+    if (not film_code.insert({name, i}).second) return bad_input(file, "repeats the film " + name);
+    // Saves the film names
+    instance.films[i] = name;
+    // Initializes with 0 films that cannot be projected
+    instance.restrictions[i] = Pair(i, 0);
+  }
+
+  // Reading films that can not been projected at the same time
+  in >> instance.n_PairsFilms;
+  if (not in or instance.n_PairsFilms < 0) return bad_input(file, "does not give the number of incompatible pairs");
+  // At the beginning there are not incompatibilities
+  instance.relations_graph.assign(n_films, vector<bool> (n_films, false));
+  string film1, film2;
+  for (int i = 0; i < instance.n_PairsFilms; ++i){
+    // Reads the films names
+    in >> film1 >> film2;
+    if (not in) return bad_input(file, "has fewer incompatible pairs than it says");
+    if (film_code.count(film1) == 0 or film_code.count(film2) == 0) return bad_input(file, "has an incompatibility with an unknown film");
+    int code1 = film_code[film1];
+    int code2 = film_code[film2];
+    // Increases the number of restrictions each film has
+    instance.restrictions[code1].second += 1;
+    instance.restrictions[code2].second += 1;
+    // Marks the boxes corresponding to the two films as true, indicating
+    // there is an incompatibility
+    instance.relations_graph[code1][code2] = true;
+    instance.relations_graph[code2][code1] = true;
+  }
+
+  // Sorting films by restrictions
+  sort(instance.restrictions.begin(), instance.restrictions.end(), comparator);
+
+  // Reading cinema rooms
+  in >> instance.n_CinRooms;
+  if (not in or instance.n_CinRooms <= 0) return bad_input(file, "does not give a positive number of cinema rooms");
+  instance.CinRooms.resize(instance.n_CinRooms);
+  // Saves the cinema names
+  for (int i = 0; i < instance.n_CinRooms; ++i) in >> instance.CinRooms[i];
+  if (not in) return bad_input(file, "has fewer cinema rooms than it says");
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: renumber
+* Function: Gives the films new numbers following the order
+            chosen with --renumber: "degree" numbers them by
+            decreasing incompatibilities and "rcm" follows
+            the reverse Cuthill-McKee order, which gives
+            close numbers to incompatible films, so that the
+            rows of relations_graph checked together are
+            close in memory; "none" keeps them. The films
+            keep their names, so the schedules written do
+            not change, and original_code tells the number
+            each one had.
+* Parameters: instance: Instance to renumber.
+              order: "none", "degree" or "rcm".
+* Return: True unless the order is unknown.
+-------------------------------------------------------- */
+inline bool renumber(Instance& instance, const string& order){
+  int n_films = instance.n_films;
+  vector<int>& original_code = instance.original_code;
+  original_code.resize(n_films);
+  for (int i = 0; i < n_films; ++i) original_code[i] = i;
+  if (order == "none") return true;
+  if (order != "degree" and order != "rcm"){
+    cerr << "Unknown renumbering " << order << endl;
+    return false;
+  }
+  vector<vector<bool>>& relations_graph = instance.relations_graph;
+  // Films sorted by decreasing incompatibilities
+  vector<int> degree(n_films);
+  vector<Pair> by_degree(n_films);
+  for (int i = 0; i < n_films; ++i){
+    degree[i] = count(relations_graph[i].begin(), relations_graph[i].end(), true);
+    by_degree[i] = Pair(i, degree[i]);
+  }
+  stable_sort(by_degree.begin(), by_degree.end(), comparator);
+  if (order == "degree"){
+    for (int i = 0; i < n_films; ++i) original_code[i] = by_degree[i].first;
+  }
+  else{
+    // Breadth-first search starting from the films with less
+    // incompatibilities and visiting the neighbours of each film from the
+    // one with less incompatibilities; original_code is used as the queue
+    vector<bool> visited(n_films, false);
+    vector<Pair> neighbours;
+    int queued = 0;
+    for (int start = n_films-1; start >= 0; --start){
+      if (visited[by_degree[start].first]) continue;
+      visited[by_degree[start].first] = true;
+      original_code[queued++] = by_degree[start].first;
+      for (int head = queued-1; head < queued; ++head){
+        int code = original_code[head];
+        neighbours.clear();
+        for (int other = 0; other < n_films; ++other){
+          if (relations_graph[code][other] and not visited[other]){
+            visited[other] = true;
+            neighbours.push_back(Pair(other, degree[other]));
+          }
+        }
+        stable_sort(neighbours.begin(), neighbours.end(), comparator);
+        for (int k = int(neighbours.size())-1; k >= 0; --k) original_code[queued++] = neighbours[k].first;
+      }
+    }
+    reverse(original_code.begin(), original_code.end());
+  }
+  // Permute the names and the incompatibilities
+  vector<string> renamed(n_films);
+  vector<vector<bool>> renumbered_graph(n_films, vector<bool> (n_films, false));
+  for (int i = 0; i < n_films; ++i){
+    renamed[i] = instance.films[original_code[i]];
+    for (int j = 0; j < n_films; ++j) renumbered_graph[i][j] = relations_graph[original_code[i]][original_code[j]];
+  }
+  instance.films.swap(renamed);
+  relations_graph.swap(renumbered_graph);
+  // The films are still placed in the same order
+  vector<int> new_code(n_films);
+  for (int i = 0; i < n_films; ++i) new_code[original_code[i]] = i;
+  for (int i = 0; i < n_films; ++i) instance.restrictions[i].first = new_code[instance.restrictions[i].first];
+  return true;
+}
+
+#endif
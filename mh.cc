@@ -16,90 +16,134 @@ Date: 03_01_2022
 #include <iostream>
 #include <vector>
 #include <ctime>
-#include <map>
 #include <algorithm>
 #include <fstream>
-#include <utility>
-#include <math.h>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <stdlib.h>
-#include <random>
-
-using namespace std;
+#include <cstdint>
+#include "mh.h"
 
 /***********************************************************
                  CONSTANTS AND VARIABLES
 ***********************************************************/
 
-unsigned t0, t1; // Time variables
+clock_t t0, t1; // Time variables (t0 goes below 0 when a run is resumed)
 string input_file, output_file; // Files to read input and write output
 
-int n_films; // |P|: Films number
-int n_PairsFilms; // |L|: Pair of films that cannot be projected together
-int n_CinRooms; // |S|: Cinema rooms number
+Instance instance; // Instance being solved
+
+string renumbering = "none"; // Order of the film numbers: "none" keeps the
+// order of the input, "degree" or "rcm" (see renumber)
 
-int best_days; // Will take constance of the minimum number of days
-// found to solve the problem
+Metaheuristic solver; // State of the search (see mh.h)
 
-vector<string> films; // Vector with film names
-vector<string> CinRooms; // Vector with cinema rooms names
+Organization best_schedule; // Best schedule found
 
-map<string, int> film_code;// Map that assigns a film to a number
+const int CHECKPOINT_VERSION = 1; // Version of the checkpoint files
+string checkpoint_file; // Where the search is saved and resumed from
+double checkpoint_every; // Seconds between checkpoints (0 to never save it)
+clock_t next_checkpoint; // When the next checkpoint is due
 
-vector<vector<bool>> relations_graph; // Boolean matrix that
-// indicates if a film can be projected with another one or not
+ofstream stats; // Where the temperature and acceptance rates are written
+// (not open if they are not wanted)
 
-using Organization = vector<vector<int>>; // Matrix with the festival
-// organization; each row is a day and each column is a cinema room
+int stream_fd = -1; // Descriptor where the improving solutions are streamed
+// (-1 if they are only written on the output file)
+vector<int> streamed_day, streamed_room; // Day and cinema room of each film
+// on the last streamed solution
+vector<int> stream_record; // Buffer where each streamed record is built
 
 /***********************************************************
                         FUNCTIONS
 ***********************************************************/
 
 /* --------------------------------------------------------
-* Name: read_data
-* Function: Reads the input from a file and process it.
-* Parameters: file: Name of the file from where we want to
-             get the input.
+* Name: open_stream
+* Function: Opens the channel where every improving solution
+            is streamed as soon as it is found: "-" is the
+            standard output, "unix:<path>" a local Unix
+            socket and any other name a file or a FIFO.
+* Parameters: target: Where to stream the solutions.
 * Return: -
 -------------------------------------------------------- */
-void read_data(){
-  // Performing the input of a file
-  ifstream in(input_file);
-
-  // Reading films
-  in >> n_films;
-  films.resize(n_films);
-  string name;
-  for (int i = 0; i < n_films; ++i){
-    // Reads the film name
-    in >> name;
-    // Assigning the film to a number
-    film_code.insert({name, i});
-    // Saves the film names
-    films[i] = name;
+void open_stream(const string& target){
+  // A reader that goes away must not kill the search
+  signal(SIGPIPE, SIG_IGN);
+  if (target == "-") stream_fd = STDOUT_FILENO;
+  else if (target.compare(0, 5, "unix:") == 0){
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, target.c_str()+5, sizeof(address.sun_path)-1);
+    stream_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (stream_fd >= 0 and connect(stream_fd, (sockaddr*)&address, sizeof(address)) < 0){
+      close(stream_fd);
+      stream_fd = -1;
+    }
   }
+  // Opening a FIFO waits until there is someone reading it
+  else stream_fd = open(target.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (stream_fd < 0) cerr << "Cannot stream solutions to " << target << endl;
+  // Nothing has been streamed yet, so the first record has every film
+  streamed_day.assign(instance.n_films, -1);
+  streamed_room.assign(instance.n_films, -1);
+  stream_record.reserve(2 + 3 + 3*instance.n_films);
+}
 
-  // Reading films that cannot be projected at the same time
-  in >> n_PairsFilms;
-  // At the beginning there are not incompatibilities
-  relations_graph.resize(n_films, vector<bool> (n_films, false));
-  string film1, film2;
-  for (int i = 0; i < n_PairsFilms; ++i){
-    // Reads the films names
-    in >> film1 >> film2;
-    int code1 = film_code[film1];
-    int code2 = film_code[film2];
-    // Marks the boxes corresponding to the two films as true, indicating
-    // there is an incompatibility
-    relations_graph[code1][code2] = true;
-    relations_graph[code2][code1] = true;
+/* --------------------------------------------------------
+* Name: stream_solution
+* Function: Sends an improving solution through the stream
+            as a length-prefixed record of 32-bit words in
+            host byte order: the length in bytes of what
+            follows, the days, the elapsed time (a double),
+            the number of films that changed with respect
+            to the previous record and, for each of them,
+            its number, day and cinema room.
+* Parameters: best: Schedule found.
+              days: Days the festival lasts.
+              time: Seconds it has taken to find it.
+* Return: -
+-------------------------------------------------------- */
+void stream_solution(const Organization& best, int days, double time){
+  if (stream_fd < 0) return;
+  // Leave room for the length, which is known at the end
+  stream_record.assign(1, 0);
+  stream_record.push_back(days);
+  int time_words[2];
+  memcpy(time_words, &time, sizeof(time));
+  stream_record.push_back(time_words[0]);
+  stream_record.push_back(time_words[1]);
+  stream_record.push_back(0);
+  for (int code = 0; code < instance.n_films; ++code){
+    if (best.film_day[code] != streamed_day[code] or best.film_room[code] != streamed_room[code]){
+      streamed_day[code] = best.film_day[code];
+      streamed_room[code] = best.film_room[code];
+      stream_record.push_back(instance.original_code[code]);
+      stream_record.push_back(streamed_day[code]);
+      stream_record.push_back(streamed_room[code]);
+    }
+  }
+  stream_record[4] = (int(stream_record.size())-5)/3;
+  stream_record[0] = (int(stream_record.size())-1)*sizeof(int);
+  // Send the whole record, even if the channel takes it in pieces
+  const char* data = (const char*)stream_record.data();
+  size_t pending = stream_record.size()*sizeof(int);
+  while (pending > 0){
+    ssize_t sent = ::write(stream_fd, data, pending);
+    if (sent <= 0){
+      // The reader has gone: keep solving without streaming
+      if (stream_fd != STDOUT_FILENO) close(stream_fd);
+      stream_fd = -1;
+      return;
+    }
+    data += sent;
+    pending -= sent;
   }
-
-  // Reading cinema rooms
-  in >> n_CinRooms;
-  CinRooms.resize(n_CinRooms);
-  // Saves the cinema names
-  for (int i = 0; i < n_CinRooms; ++i) in >> CinRooms[i];
 }
 
 /* --------------------------------------------------------
@@ -115,317 +159,130 @@ void write(const Organization& best){
   // Calculates the time it has taken to know the schedule
   t1 = clock();
   double time = (double(t1-t0)/CLOCKS_PER_SEC);
-  // Performing the output of a file
-  ofstream file;
-  // Set decimal precision with 1 decimal
-  file.setf(ios::fixed);
-  file.precision(1);
-  // Creating or opening the file where we will write the output
-  file.open(output_file);
-  // Writes the time it has taken to compute the solution
-  file << time << endl;
-  // Writes how many days the festival lasts
-  file << int(best.size()) << endl;
-  // For each film writes on which day it will be performed and
-  // at which cinema room
-  for (int i = 0; i < int(best.size()); ++i){
-    for (int j = 0; j < int(best[i].size()); ++j){
-      file << films[best[i][j]] << " " << i+1 << " " << CinRooms[j] << endl;
-    }
-  }
-  file.close();
+  write_schedule(output_file, instance, best, time);
+  // Keep it for the checkpoints
+  best_schedule = best;
+  // Let whoever is monitoring the search know about it
+  stream_solution(best, best.days, time);
 }
 
-
 /* --------------------------------------------------------
-* Name: can_be_projected
-* Function: Indicates if a film can be projected on a
-            given a day depending on if it is incompatible
-            with the thers films of that day or not.
-* Parameters: actual: Matrix with the schedule (rows are
-              the days and, the columns, the cinema rooms).
-              day: The day we want to check.
-              code: Film number.
-* Return: True if a film can be projected that day or
-          false otherwise.
--------------------------------------------------------- */
-bool can_be_projected(const Organization& actual, int day, int code){
-  for (int room = 0; room < int(actual[day].size()); ++room) if (relations_graph[code][actual[day][room]]) return false;
-  return true;
-}
-
-/* --------------------------------------------------------
-* Name: how_many_incompatibilities
-* Function: Counts how many incompatibilities has a given
-            film on the day it is being projected.
-* Parameters: actual: Matrix with the schedule (rows are
-              the days and, the columns, the cinema rooms).
-              day: The day we want to check.
-              code: Film number.
-* Return: Number of incompatibilities of the film given
-          on the day it is.
--------------------------------------------------------- */
-int how_many_incompatibilities(const Organization& actual, int day, int code){
-  int incompatibilities = 0;
-  for (int room = 0; room < int(actual[day].size()); ++room) if (relations_graph[code][actual[day][room]]) incompatibilities += 1;
-  return incompatibilities;
-}
-
-/* --------------------------------------------------------
-* Name: generate_initial_solution
-* Function: Generates a possible solution to solve the
-            problem: a schedule for the festival with
-            no incompatibilities between films. This
-            solution is generated by a greedy randomized
-            algorithm.
+* Name: save_checkpoint
+* Function: Writes the state of the search on the checkpoint
+            file: the best schedule, the success rates of
+            the neighbourhoods and the state of the random
+            generator, with the films numbered as on the
+            input. It is written on a temporary file and
+            renamed, so a checkpoint is never left
+            half-written.
 * Parameters: -
-* Return: A schedule for the festival.
+* Return: -
 -------------------------------------------------------- */
-Organization generate_initial_solution(){
-  Organization actual;
-  vector<int> p(n_films);
-  // Fill the vector with ordered numbers
-  for (int k = 0; k < n_films; ++k) p[k] = k;
-
-  // Randomly rearrange elements in range using generator
-  shuffle(p.begin(), p.end(), default_random_engine());
-
-  for (int film_index = 0; film_index < n_films; ++film_index){
-    // Projected will keep track of the film to decide if it has been placed
-    bool projected = false;
-    // Go through the days if the film has not been projected yet
-    for (int day = 0; day < int(actual.size()) and not projected; ++day){
-      // If the day has enough space and there are not incompatibilities, then we place the film
-      if (int(actual[day].size()) < n_CinRooms and can_be_projected(actual, day, p[film_index])){
-        actual[day].push_back(p[film_index]);
-        projected = true;
-      }
-    }
-    // If the place has not been placed, then place it in a new day
-    if (not projected){
-      actual.push_back({p[film_index]});
-    }
+void save_checkpoint(){
+  string temporary = checkpoint_file + ".tmp";
+  ofstream file(temporary);
+  file << "mh " << CHECKPOINT_VERSION << endl;
+  file << instance.n_films << " " << instance.n_PairsFilms << " " << instance.n_CinRooms << endl;
+  file << solver.best_days << " " << double(clock()-t0)/CLOCKS_PER_SEC << endl;
+  for (int move = 0; move < N_MOVES; ++move) file << solver.move_success[move] << " ";
+  file << endl;
+  file << best_schedule.days << endl;
+  for (int day = 0; day < best_schedule.days; ++day){
+    file << best_schedule.filled[day];
+    for (int room = 0; room < best_schedule.filled[day]; ++room) file << " " << instance.original_code[best_schedule.schedule[day*instance.n_CinRooms + room]];
+    file << endl;
   }
-  return actual;
+  file << solver.rng << endl;
+  file.close();
+  rename(temporary.c_str(), checkpoint_file.c_str());
 }
 
 /* --------------------------------------------------------
-* Name: solve_incompatibilities
-* Function: Solves incompatibilities among the days and
-            returns if there persists incompatibilities
-            following a Simulated Annealing algorithm
-* Parameters: actual: Matrix with the schedule (rows are
-              the days and, the columns, the cinema rooms).
-              day_incomp: Vector with how many
-              incompatibilities has each day.
-              incompatibilities: Total number of
-              incompatibilities.
-* Return: true if actual ends up with no incompatibilities,
-          false otherwise.
+* Name: load_checkpoint
+* Function: Restores the state of the search saved by
+            save_checkpoint.
+* Parameters: -
+* Return: -
 -------------------------------------------------------- */
-bool solve_incompatibilities(Organization& actual, vector<int>& day_incomp, int& incompatibilities){
-  // Set initial temperature needed for Simulated Annealing
-  float T = 0.1;
-  // While there are incompatibilities and T is bigger enough
-  while (incompatibilities > 0 and T > 0.0000005){
-    // Initialize a variable to check which day needs to be solved
-    int day_to_solve;
-    // At the beginning no incomaptibilities have been found
-    bool incomp_found = false;
-    // For each day and while no incomaptibilities have been found,
-    for (int i = 0; i < int(day_incomp.size()) and not incomp_found; ++i){
-      // Check if there are incompatibilities
-      if (day_incomp[i] > 0){
-        // Save the day as the one that needs to be solved
-        day_to_solve = i;
-        // And indicate we find an incompatibility to finish the for
-        incomp_found = true;
-      }
-    }
-    // Initialize incomp_found again for next iterations
-    incomp_found = false;
-
-    // Will need to save the changes on the number of total incompatibilities
-    // and the ones on each day
-    int old_incompatibilities2, old_incompatibilities1;
-    int new_incompatibilities1, new_incompatibilities2;
-    int new_incompatibilities, old_incompatibilities;
-
-    // Search in the day with incompatibilities the first film generating conflicts
-    for (int film_index = 0; film_index < int(actual[day_to_solve].size()); ++film_index){
-      old_incompatibilities1 = how_many_incompatibilities(actual, day_to_solve, actual[day_to_solve][film_index]);
-      // When found,
-      if (old_incompatibilities1 != 0){
-        int random_day;
-        // choose a new different day
-        do random_day = rand()%int(actual.size()); while (random_day == day_to_solve);
-        // and a new film
-        int random_film = rand()%int(actual[random_day].size());
-        // Calculate the incomaptibilities that the film chosen at random generates on the day it is
-        old_incompatibilities2 = how_many_incompatibilities(actual, random_day, actual[random_day][random_film]);
-        // Change the position of the film chosen at random with the one found at the beginning
-        int aux = actual[day_to_solve][film_index];
-        actual[day_to_solve][film_index] = actual[random_day][random_film];
-        actual[random_day][random_film] = aux;
-        // Compute the new incompatibilities they generate on the days they are assigned now
-        new_incompatibilities1 = how_many_incompatibilities(actual, day_to_solve, actual[day_to_solve][film_index]);
-        new_incompatibilities2 = how_many_incompatibilities(actual, random_day, actual[random_day][random_film]);
-        new_incompatibilities = new_incompatibilities1 + new_incompatibilities2;
-        old_incompatibilities = old_incompatibilities1 + old_incompatibilities2;
-        // If the previous incompatibilities were greater than the new ones
-        if (old_incompatibilities > new_incompatibilities){
-          // We update the incompatibilities numbers accepting the change done
-          incompatibilities = incompatibilities - old_incompatibilities + new_incompatibilities;
-          day_incomp[day_to_solve] += new_incompatibilities1 - old_incompatibilities1;
-          day_incomp[random_day] += new_incompatibilities2 - old_incompatibilities2;
-        }
-        // Otherwise,
-        else{
-          // Calculate the probability of accepting the change although it is a worth solution
-          // It will follow and exponencial law; the score functions are the number
-          // of incompatibilities of the new and old parcial solution
-          float p = exp(-(new_incompatibilities - old_incompatibilities)/T);
-          // Generate a random value between 0 and 1
-          float random_value = rand()/double(RAND_MAX);
-          // If the random_value is lower or equal to the probability of acceptance,
-          if (random_value <= p){
-            // update incompatibilities and accept the solution; this avoids getting
-            // stuck
-            day_incomp[day_to_solve] += new_incompatibilities1 - old_incompatibilities1;
-            day_incomp[random_day] += new_incompatibilities2 - old_incompatibilities2;
-            incompatibilities = incompatibilities - old_incompatibilities + new_incompatibilities;
-          }
-          // Otherwise,
-          else{
-            // Undo the changes on the schedule
-            actual[random_day][random_film]  = actual[day_to_solve][film_index];
-            actual[day_to_solve][film_index] = aux;
-          }
-        }
-        // Modify T making it lower in order to make p lower in the next iteration
-        T *= 0.999;
+void load_checkpoint(){
+  ifstream file(checkpoint_file);
+  string kind;
+  int version, films_number, pairs_number, rooms_number;
+  file >> kind >> version >> films_number >> pairs_number >> rooms_number;
+  if (not file or kind != "mh" or version != CHECKPOINT_VERSION or films_number != instance.n_films
+      or pairs_number != instance.n_PairsFilms or rooms_number != instance.n_CinRooms){
+    cerr << "Cannot resume from " << checkpoint_file << endl;
+    exit(1);
+  }
+  double time;
+  int days;
+  file >> solver.best_days >> time;
+  bool valid = file and solver.best_days > 0 and solver.best_days <= instance.n_films and time >= 0;
+  for (int move = 0; valid and move < N_MOVES; ++move){
+    file >> solver.move_success[move];
+    valid = file and solver.move_success[move] >= 0 and solver.move_success[move] <= 1;
+  }
+  file >> days;
+  valid = valid and file and days >= 0 and days <= instance.n_films;
+  // The films are saved with the numbers they had on the input; each one
+  // must appear once, on a day with room and no incompatible film
+  vector<int> new_code(instance.n_films);
+  for (int i = 0; i < instance.n_films; ++i) new_code[instance.original_code[i]] = i;
+  int placed = 0;
+  for (int day = 0; valid and day < days; ++day){
+    int filled, code;
+    file >> filled;
+    valid = file and filled > 0 and filled <= instance.n_CinRooms;
+    for (int room = 0; valid and room < filled; ++room){
+      file >> code;
+      valid = file and code >= 0 and code < instance.n_films and best_schedule.film_day[new_code[code]] == -1
+              and can_be_projected<0>(instance, best_schedule, day, new_code[code]);
+      if (valid){
+        place_film(best_schedule, day, new_code[code]);
+        ++placed;
       }
     }
   }
-  // If there are no incompatibilities
-  if (incompatibilities == 0){
-    if (int(actual.size()) < best_days){
-      best_days = int(actual.size());
-      write(actual);
-    }
-    // We return true
-    return true;
+  // Either no schedule had been found yet, or the best one has every film
+  if (days == 0) valid = valid and solver.best_days == instance.n_films;
+  else valid = valid and placed == instance.n_films and solver.best_days == days;
+  file >> solver.rng;
+  if (not valid or not file){
+    cerr << "Cannot resume from " << checkpoint_file << endl;
+    exit(1);
   }
-  // Otherwise, we return false
-  return false;
+  // Keep counting the time from where the previous run stopped
+  t0 = clock() - clock_t(time*CLOCKS_PER_SEC);
 }
 
-
 /* --------------------------------------------------------
-* Name: improve
-* Function: Tries to remove a day from the schedule
-            placing the films on the last day in empty
-            cinema rooms of previous days.
-* Parameters: actual: Matrix with the schedule (rows are
-              the days and, the columns, the cinema rooms).
-              day_incomp: Vector with how many
-              incompatibilities has each day.
-              incompatibilities: Total number of
-              incompatibilities.
+* Name: found
+* Function: Called by the search with every schedule that
+            improves the best one: writes it.
+* Parameters: search: Search.
+              best: Schedule found.
 * Return: -
 -------------------------------------------------------- */
-void improve(Organization& actual, vector<int>& day_incomp, int& incompatibilities){
-  // Set the last day as the one to being removed
-  int day_to_remove = int(actual.size())-1;
-  int day_to_complete;
-  int film_to_remove;
-  // Set an initial big number of incompatibilities in order to, later, find
-  // the minimum value for the variables counting them
-  int incompatibilities_generated, new_incompatibilities = 1e6;
-  // While there are films in the day to remove
-  while (int(actual[day_to_remove].size()) > 0){
-    // Get the film last film as the one to being removed
-    film_to_remove = actual[day_to_remove][int(actual[day_to_remove].size())-1];
-    // At the beginning, not empty spaces have been found
-    bool empty_spaces = false;
-    // Look for an empty space on the previous days
-    for (int i = 0; i < day_to_remove; ++i){
-      // If there are empty cinema rooms,
-      if (int(actual[i].size()) < n_CinRooms){
-        // check the number of incompatibilities it would generate the film to
-        // remove in that spot
-        incompatibilities_generated = how_many_incompatibilities(actual, i, film_to_remove);
-        // If the incompatibilities generated are less than the minimum found at the moment,
-        if (incompatibilities_generated < new_incompatibilities){
-          // Update the new_incompatibilities: now the minimum is the ones just found
-          new_incompatibilities = incompatibilities_generated;
-          // And indicate on which day we can place the film in order to complete it
-          day_to_complete = i;
-          // We have found an empty space
-          empty_spaces = true;
-        }
-      }
-    }
-    // In case there are empty spaces
-    if (empty_spaces){
-      // Update incompatibilities of the day we are placing the film
-      day_incomp[day_to_complete] += new_incompatibilities;
-      // Update total incompatibilities
-      incompatibilities += new_incompatibilities;
-      // We pop the film from the day to remove
-      actual[day_to_remove].pop_back();
-      // And add the film to remove to the day to complete
-      actual[day_to_complete].push_back(film_to_remove);
-      // Intialize empty_spaces and new_incompatibilities again to remove the
-      // next film on the day to remove
-      empty_spaces = false;
-      new_incompatibilities = 1e6;
-    }
-    // Otherwise
-    else{
-      // In case the number of actual days are less than the best days,
-      if (int(actual.size()) < best_days){
-        // Update best days
-        best_days = int(actual.size());
-        // And write the result in the file; this is the best solution by far
-        // as there are not empty cinema rooms and all films are placed
-        write(actual);
-      }
-    }
-  }
-  // If the day to remove is empty
-  if ((actual[day_to_remove].size()) == 0){
-    // We remove it from the schedule
-    actual.pop_back();
-    day_incomp.pop_back();
-  }
+void found(Search& search, const Organization& best){
+  write(best);
 }
 
 /* --------------------------------------------------------
-* Name: GRASP
-* Function: Greedy Randomized Adaptive Search Procedure
-* Parameters: -
-* Return: -
+* Name: interrupted
+* Function: Called by the search from time to time: saves
+            it when a checkpoint is due and stops it when the
+            time limit has passed.
+* Parameters: search: Search.
+* Return: true if there is a time limit and it has passed.
 -------------------------------------------------------- */
-void GRASP(){
-  while(true){
-    // Creates a first solution
-    Organization actual = generate_initial_solution();
-    int days = int(actual.size());
-    // If the number of days of the solution is lower than the one on the best
-    // solution,
-    if (days < best_days){
-      // Write the time required, days the festival lasts and schedule
-      write(actual);
-      // Update the minimum number of days found
-      best_days = days;
-    }
-    // Try to remove a day from the solution and, once this happens, try to
-    // solve the incompatibilities generated
-    int incompatibilities = 0;
-    vector<int> day_incomp(days, 0);
-    do improve(actual, day_incomp, incompatibilities); while (solve_incompatibilities(actual, day_incomp, incompatibilities));
+bool interrupted(Search& search){
+  clock_t now = clock();
+  search.elapsed = double(now-t0)/CLOCKS_PER_SEC;
+  if (checkpoint_every > 0 and now >= next_checkpoint){
+    save_checkpoint();
+    next_checkpoint = clock() + checkpoint_every*CLOCKS_PER_SEC;
   }
+  return search.time_limit > 0 and search.elapsed >= search.time_limit;
 }
 
 /***********************************************************
@@ -443,16 +300,58 @@ void GRASP(){
 int main(int argc, char** argv){
   // We will want the code to compute completely random the variables
   // that need to be randomized
-  srand(time(NULL));
+  solver.rng.seed(time(NULL));
+  // Read the options: --resume continues from the last checkpoint,
+  // --checkpoint-every=SECONDS sets how often it is written (0 never),
+  // --renumber=ORDER gives the films new numbers, --memetic evolves a pool
+  // of schedules instead of restarting GRASP, --time-limit=SECONDS stops the
+  // search and --stats=FILE writes how the temperature and the acceptance
+  // rate evolve
+  bool resume = false;
+  checkpoint_every = 60;
+  bool memetic = false;
+  double time_limit = 0;
+  vector<string> arguments;
+  for (int i = 1; i < argc; ++i){
+    string argument = argv[i];
+    if (argument == "--resume") resume = true;
+    else if (argument == "--memetic") memetic = true;
+    else if (argument.compare(0, 13, "--time-limit=") == 0) time_limit = atof(argument.c_str()+13);
+    else if (argument.compare(0, 8, "--stats=") == 0){
+      stats.open(argument.substr(8));
+      stats << "time\tdays\tincompatibilities\ttemperature\tacceptance\ttarget" << endl;
+    }
+    else if (argument.compare(0, 19, "--checkpoint-every=") == 0) checkpoint_every = atof(argument.c_str()+19);
+    else if (argument.compare(0, 11, "--renumber=") == 0) renumbering = argument.substr(11);
+    else arguments.push_back(argument);
+  }
   // Set the intput and output files
-  input_file = string(argv[1]);
-  output_file = string(argv[2]);
+  input_file = arguments[0];
+  output_file = arguments[1];
+  checkpoint_file = output_file + ".checkpoint";
   // Read data
-  read_data();
+  if (not read_data(input_file, instance)) exit(1);
+  // Optionally, give incompatible films close numbers
+  if (not renumber(instance, renumbering)) exit(1);
+  // Optionally, stream every improving solution
+  if (arguments.size() > 2) open_stream(arguments[2]);
+  // Prepare the search
+  init_metaheuristic(solver, instance);
+  solver.memetic = memetic;
+  solver.time_limit = time_limit;
+  solver.elapsed = 0;
+  if (stats.is_open()) solver.stats = &stats;
+  solver.found = found;
+  solver.interrupted = interrupted;
+  solver.data = nullptr;
   // Start counting time
   t0 = clock();
   // In the worst case, there will be as many days as films
-  best_days = n_films;
-  // Schedule the festival
-  GRASP();
+  solver.best_days = instance.n_films;
+  init_organization(best_schedule, instance);
+  // Continue where the previous run was left
+  if (resume) load_checkpoint();
+  next_checkpoint = clock() + checkpoint_every*CLOCKS_PER_SEC;
+  // Schedule the festival (see mh.h)
+  metaheuristic(solver);
 }
@@ -0,0 +1,947 @@
+/*********************************************************
+File name: mh.h
+File function: the metaheuristics of mh.cc: GRASP, whose
+local search removes days and solves the incompatibilities
+this generates with an adaptive Simulated Annealing over
+several neighbourhoods, and a memetic algorithm that evolves
+a pool of the schedules it finds.
+**********************************************************/
+
+#ifndef MH_H
+#define MH_H
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include <chrono>
+#include <math.h>
+#include "schedule.h"
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+const int SWAP = 0, RELOCATE = 1, KEMPE = 2, EJECTION = 3; // Neighbourhoods
+// of the local search
+const int N_MOVES = 4; // Number of neighbourhoods
+const float MIN_MOVE_WEIGHT = 0.05; // Keeps every neighbourhood in use
+const float SUCCESS_MEMORY = 0.05; // Weight of the last move on the success rates
+const int EJECTION_DEPTH = 3; // Maximum films ejected by an ejection chain
+
+const float INITIAL_ACCEPTANCE = 0.02; // Wanted rate of accepted moves that
+// increase the incompatibilities at the start of an annealing
+const float FINAL_ACCEPTANCE = 0.0001; // And at the end of it
+const int ANNEAL_WINDOW = 200; // Moves between temperature adjustments; the
+// first window of an annealing only accepts moves that do not make the
+// schedule worse and calibrates the initial temperature
+const float FROZEN = 1e-6; // Temperature at which no move that makes the
+// schedule worse is accepted
+const float MAX_CORRECTION = 4; // Largest factor by which a window may
+// raise or lower the temperature
+const float STAGNATION = 0.25; // Fraction of the budget without reducing
+// the incompatibilities after which the temperature is raised
+const float REHEAT = 0.5; // Fraction of the initial temperature reheating
+// goes back to
+const long DEFAULT_BUDGET = 12000; // Moves of an annealing with no time limit
+const long MIN_BUDGET = 1000; // Fewest moves of an annealing with a time limit
+const float ANNEAL_SHARE = 0.01; // Fraction of the time left an annealing
+// may take
+
+const int POOL_SIZE = 10; // Schedules kept on the pool of the memetic search
+const float MIN_DISTANCE = 0.05; // Fraction of the films by which an offspring
+// has to differ from the schedules of the pool to be a new one
+
+struct Metaheuristic : Search {
+  bool memetic; // Whether a pool of schedules is evolved instead of
+  // restarting GRASP from scratch on every iteration
+  float move_success[N_MOVES]; // Recent rate of moves of each
+  // neighbourhood that reduced the incompatibilities
+  vector<int> film_order; // Order in which the films are placed by the
+  // randomized greedy algorithm
+  vector<int> kempe_chain; // Films of the Kempe chain being built
+  vector<bool> in_chain; // Whether each film is in the Kempe chain
+  vector<int> kempe_buffer; // Films of a day rebuilt by a Kempe move
+  vector<int> kempe_days[2]; // Both days rebuilt by a Kempe move
+  int ejection_days[EJECTION_DEPTH], ejection_rooms[EJECTION_DEPTH]; // Slots
+  // of the films ejected by an ejection chain
+  long uphill_tried, uphill_accepted; // Moves that would increase the
+  // incompatibilities proposed and accepted since the last adjustment
+  long uphill_increase; // Sum of the increases of the moves proposed
+  long anneal_moves; // Moves made by every annealing
+  double anneal_seconds; // Seconds spent by every annealing
+  ostream* stats; // Where the temperature and acceptance rates are written
+  // (null if they are not wanted)
+  vector<bool> inherited; // Whether each film has been placed on the offspring
+  vector<int> left_on_day[2]; // Films of each day of both parents that the
+  // offspring has not inherited yet
+  vector<int> overlap; // Films of a day shared with each day of another schedule
+};
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: init_metaheuristic
+* Function: Prepares a metaheuristic search, reserving the
+            buffers of the neighbourhoods and of the
+            crossover. Every neighbourhood starts with the
+            same success rate.
+* Parameters: mh: Search to prepare.
+              instance: Instance to solve.
+* Return: -
+-------------------------------------------------------- */
+inline void init_metaheuristic(Metaheuristic& mh, const Instance& instance){
+  mh.instance = &instance;
+  mh.memetic = false;
+  for (int move = 0; move < N_MOVES; ++move) mh.move_success[move] = 0.5;
+  mh.film_order.resize(instance.n_films);
+  mh.in_chain.assign(instance.n_films, false);
+  mh.kempe_chain.reserve(2*instance.n_CinRooms);
+  mh.kempe_buffer.reserve(2*instance.n_CinRooms);
+  mh.kempe_days[0].reserve(2*instance.n_CinRooms);
+  mh.kempe_days[1].reserve(2*instance.n_CinRooms);
+  mh.uphill_tried = mh.uphill_accepted = mh.uphill_increase = 0;
+  mh.anneal_moves = 0;
+  mh.anneal_seconds = 0;
+  mh.stats = nullptr;
+  mh.left_on_day[0].resize(instance.n_films);
+  mh.left_on_day[1].resize(instance.n_films);
+  mh.overlap.assign(instance.n_films, 0);
+}
+
+/* --------------------------------------------------------
+* Name: generate_initial_solution
+* Function: Generates a possible solution to solve the
+            problem: a schedule for the festival with
+            no incompatibilities between films. This
+            solution is generated by a greedy randomized
+            algorithm.
+* Parameters: mh: Search.
+              actual: Schedule where the solution is built;
+              its previous content is discarded.
+* Return: -
+-------------------------------------------------------- */
+template <int ROOMS>
+void generate_initial_solution(Metaheuristic& mh, Organization& actual){
+  const Instance& instance = *mh.instance;
+  clear_organization(actual);
+  // Fill the vector with ordered numbers
+  for (int k = 0; k < instance.n_films; ++k) mh.film_order[k] = k;
+
+  // Randomly rearrange elements in range using generator
+  shuffle(mh.film_order.begin(), mh.film_order.end(), mh.rng);
+
+  for (int film_index = 0; film_index < instance.n_films; ++film_index){
+    // Projected will keep track of the film to decide if it has been placed
+    bool projected = false;
+    // Go through the days if the film has not been projected yet
+    for (int day = 0; day < actual.days and not projected; ++day){
+      // If the day has enough space and there are not incompatibilities, then we place the film
+      if (actual.filled[day] < room_count<ROOMS>(actual) and can_be_projected<ROOMS>(instance, actual, day, mh.film_order[film_index])){
+        place_film(actual, day, mh.film_order[film_index]);
+        projected = true;
+      }
+    }
+    // If the place has not been placed, then place it in a new day
+    if (not projected){
+      place_film(actual, actual.days, mh.film_order[film_index]);
+    }
+  }
+}
+
+/* --------------------------------------------------------
+* Name: accept
+* Function: Decides, following the Simulated Annealing
+            criterion, whether a move is accepted: always if
+            it does not increase the incompatibilities and,
+            otherwise, with a probability that decreases
+            with the temperature. The moves that increase
+            them are counted for the acceptance rate.
+* Parameters: mh: Search.
+              delta: Change on the total incompatibilities.
+              T: Temperature.
+* Return: True if the move is accepted.
+-------------------------------------------------------- */
+bool accept(Metaheuristic& mh, int delta, float T){
+  if (delta < 0) return true;
+  // It will follow and exponencial law; the score functions are the number
+  // of incompatibilities of the new and old parcial solution
+  float p = exp(-delta/T);
+  float random_value = mh.rng()/double(mh.rng.max());
+  // Keep track of the acceptance rate of the moves that make it worse
+  if (delta > 0){
+    mh.uphill_tried += 1;
+    mh.uphill_accepted += random_value <= p;
+    mh.uphill_increase += delta;
+  }
+  return random_value <= p;
+}
+
+/* --------------------------------------------------------
+* Name: day_incompatibilities
+* Function: Counts the pairs of incompatible films of a day.
+* Parameters: instance: Instance being solved.
+              actual: Schedule.
+              day: The day we want to check.
+* Return: Number of incompatibilities of the day.
+-------------------------------------------------------- */
+template <int ROOMS>
+int day_incompatibilities(const Instance& instance, const Organization& actual, int day){
+  const int* day_films = &actual.schedule[day*room_count<ROOMS>(actual)];
+  int incompatibilities = 0;
+  for (int i = 0; i < actual.filled[day]; ++i){
+    for (int j = i+1; j < actual.filled[day]; ++j) if (instance.relations_graph[day_films[i]][day_films[j]]) incompatibilities += 1;
+  }
+  return incompatibilities;
+}
+
+/* --------------------------------------------------------
+* Name: swap_delta
+* Function: Swaps the films of two slots on different days
+            and computes how the incompatibilities change.
+* Parameters: instance: Instance being solved.
+              actual: Schedule.
+              day1, room1: First slot.
+              day2, room2: Second slot.
+              delta1, delta2: Change on the incompatibilities
+              of each day (output).
+* Return: -
+-------------------------------------------------------- */
+template <int ROOMS>
+void swap_delta(const Instance& instance, Organization& actual, int day1, int room1, int day2, int room2, int& delta1, int& delta2){
+  int old_incompatibilities1 = how_many_incompatibilities<ROOMS>(instance, actual, day1, actual.schedule[day1*room_count<ROOMS>(actual) + room1]);
+  int old_incompatibilities2 = how_many_incompatibilities<ROOMS>(instance, actual, day2, actual.schedule[day2*room_count<ROOMS>(actual) + room2]);
+  swap_films(actual, day1, room1, day2, room2);
+  delta1 = how_many_incompatibilities<ROOMS>(instance, actual, day1, actual.schedule[day1*room_count<ROOMS>(actual) + room1]) - old_incompatibilities1;
+  delta2 = how_many_incompatibilities<ROOMS>(instance, actual, day2, actual.schedule[day2*room_count<ROOMS>(actual) + room2]) - old_incompatibilities2;
+}
+
+/* --------------------------------------------------------
+* Name: try_swap
+* Function: Swap move: exchanges a conflicting film with a
+            random film of a random day.
+* Parameters: mh: Search.
+              actual: Schedule.
+              day_incomp: Incompatibilities of each day.
+              incompatibilities: Total incompatibilities.
+              day, room: Slot of the conflicting film.
+              T: Temperature.
+* Return: Change on the total incompatibilities (0 if the
+          move is rejected).
+-------------------------------------------------------- */
+template <int ROOMS>
+int try_swap(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int& incompatibilities, int day, int room, float T){
+  const Instance& instance = *mh.instance;
+  int random_day;
+  // choose a new different day
+  do random_day = mh.rng()%actual.days; while (random_day == day);
+  // and a new film
+  int random_film = mh.rng()%actual.filled[random_day];
+  int delta1, delta2;
+  swap_delta<ROOMS>(instance, actual, day, room, random_day, random_film, delta1, delta2);
+  if (not accept(mh, delta1 + delta2, T)){
+    // Undo the changes on the schedule
+    swap_films(actual, day, room, random_day, random_film);
+    return 0;
+  }
+  day_incomp[day] += delta1;
+  day_incomp[random_day] += delta2;
+  incompatibilities += delta1 + delta2;
+  return delta1 + delta2;
+}
+
+/* --------------------------------------------------------
+* Name: try_relocate
+* Function: Relocation move: moves a conflicting film to the
+            day with free cinema rooms where it has fewer
+            incompatibilities. The last film of its day
+            takes the room it leaves.
+* Parameters: mh: Search.
+              actual: Schedule.
+              day_incomp: Incompatibilities of each day.
+              incompatibilities: Total incompatibilities.
+              day, room: Slot of the conflicting film.
+              T: Temperature.
+* Return: Change on the total incompatibilities (0 if the
+          move is rejected or not possible).
+-------------------------------------------------------- */
+template <int ROOMS>
+int try_relocate(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int& incompatibilities, int day, int room, float T){
+  const Instance& instance = *mh.instance;
+  // A day is never left empty
+  if (actual.filled[day] < 2) return 0;
+  int code = actual.schedule[day*room_count<ROOMS>(actual) + room];
+  int target = -1;
+  int target_incompatibilities = room_count<ROOMS>(actual);
+  for (int i = 0; i < actual.days; ++i){
+    if (i != day and actual.filled[i] < room_count<ROOMS>(actual)){
+      int incompatibilities_generated = how_many_incompatibilities<ROOMS>(instance, actual, i, code);
+      if (incompatibilities_generated < target_incompatibilities){
+        target = i;
+        target_incompatibilities = incompatibilities_generated;
+      }
+    }
+  }
+  if (target < 0) return 0;
+  int source_incompatibilities = how_many_incompatibilities<ROOMS>(instance, actual, day, code);
+  int delta = target_incompatibilities - source_incompatibilities;
+  if (not accept(mh, delta, T)) return 0;
+  // Bring the film to the last room of its day and take it from there
+  swap_films(actual, day, room, day, actual.filled[day]-1);
+  remove_last_film(actual, day);
+  place_film(actual, target, code);
+  day_incomp[day] -= source_incompatibilities;
+  day_incomp[target] += target_incompatibilities;
+  incompatibilities += delta;
+  return delta;
+}
+
+/* --------------------------------------------------------
+* Name: try_kempe
+* Function: Kempe-chain move: between the day of a
+            conflicting film and a random day, takes the
+            films connected to it by incompatibilities that
+            cross both days and exchanges their days. No new
+            incompatibility can appear, and the ones between
+            the chain and the rest of its day disappear. The
+            move is only done if both days keep within
+            as many films as cinema rooms.
+* Parameters: mh: Search.
+              actual: Schedule.
+              day_incomp: Incompatibilities of each day.
+              incompatibilities: Total incompatibilities.
+              day, room: Slot of the conflicting film.
+              T: Temperature.
+* Return: Change on the total incompatibilities (0 if the
+          move is rejected or not possible).
+-------------------------------------------------------- */
+template <int ROOMS>
+int try_kempe(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int& incompatibilities, int day, int room, float T){
+  const Instance& instance = *mh.instance;
+  int other;
+  do other = mh.rng()%actual.days; while (other == day);
+  // Build the chain by a breadth-first search over both days
+  mh.kempe_chain.clear();
+  mh.kempe_chain.push_back(actual.schedule[day*room_count<ROOMS>(actual) + room]);
+  mh.in_chain[mh.kempe_chain[0]] = true;
+  int moved_from_day = 0;
+  for (int k = 0; k < int(mh.kempe_chain.size()); ++k){
+    int code = mh.kempe_chain[k];
+    int opposite = actual.film_day[code] == day ? other : day;
+    if (opposite == other) ++moved_from_day;
+    const int* opposite_films = &actual.schedule[opposite*room_count<ROOMS>(actual)];
+    for (int i = 0; i < actual.filled[opposite]; ++i){
+      if (not mh.in_chain[opposite_films[i]] and instance.relations_graph[code][opposite_films[i]]){
+        mh.in_chain[opposite_films[i]] = true;
+        mh.kempe_chain.push_back(opposite_films[i]);
+      }
+    }
+  }
+  int moved_from_other = int(mh.kempe_chain.size()) - moved_from_day;
+  int new_filled_day = actual.filled[day] - moved_from_day + moved_from_other;
+  int new_filled_other = actual.filled[other] - moved_from_other + moved_from_day;
+  // Check the capacity and compute the incompatibilities that disappear
+  int delta = 0;
+  bool possible = new_filled_day <= room_count<ROOMS>(actual) and new_filled_other <= room_count<ROOMS>(actual) and new_filled_day > 0 and new_filled_other > 0;
+  for (int k = 0; k < int(mh.kempe_chain.size()) and possible; ++k){
+    int code = mh.kempe_chain[k];
+    int own = actual.film_day[code];
+    const int* own_films = &actual.schedule[own*room_count<ROOMS>(actual)];
+    for (int i = 0; i < actual.filled[own]; ++i) if (not mh.in_chain[own_films[i]] and instance.relations_graph[code][own_films[i]]) delta -= 1;
+  }
+  if (possible and accept(mh, delta, T)){
+    // Rebuild both days: the films that stay and the ones that arrive
+    for (int pass = 0; pass < 2; ++pass){
+      int rebuilt = pass == 0 ? day : other;
+      int opposite = pass == 0 ? other : day;
+      mh.kempe_buffer.clear();
+      for (int i = 0; i < actual.filled[rebuilt]; ++i){
+        int code = actual.schedule[rebuilt*room_count<ROOMS>(actual) + i];
+        if (not mh.in_chain[code]) mh.kempe_buffer.push_back(code);
+      }
+      for (int i = 0; i < actual.filled[opposite]; ++i){
+        int code = actual.schedule[opposite*room_count<ROOMS>(actual) + i];
+        if (mh.in_chain[code]) mh.kempe_buffer.push_back(code);
+      }
+      mh.kempe_days[pass] = mh.kempe_buffer;
+    }
+    for (int pass = 0; pass < 2; ++pass){
+      int rebuilt = pass == 0 ? day : other;
+      actual.filled[rebuilt] = int(mh.kempe_days[pass].size());
+      for (int i = 0; i < actual.filled[rebuilt]; ++i){
+        int code = mh.kempe_days[pass][i];
+        actual.schedule[rebuilt*room_count<ROOMS>(actual) + i] = code;
+        actual.film_day[code] = rebuilt;
+        actual.film_room[code] = i;
+      }
+    }
+    incompatibilities += delta;
+    day_incomp[day] = day_incompatibilities<ROOMS>(instance, actual, day);
+    day_incomp[other] = day_incompatibilities<ROOMS>(instance, actual, other);
+  }
+  else delta = 0;
+  for (int k = 0; k < int(mh.kempe_chain.size()); ++k) mh.in_chain[mh.kempe_chain[k]] = false;
+  return delta;
+}
+
+/* --------------------------------------------------------
+* Name: try_ejection
+* Function: Ejection-chain move: the conflicting film takes
+            the best room of a random day, ejecting the film
+            there, which takes the best room of another
+            random day, and so on for at most EJECTION_DEPTH
+            steps; the last ejected film takes the room left
+            by the first one. The chain stops as soon as the
+            incompatibilities decrease.
+* Parameters: mh: Search.
+              actual: Schedule.
+              day_incomp: Incompatibilities of each day.
+              incompatibilities: Total incompatibilities.
+              day, room: Slot of the conflicting film.
+              T: Temperature.
+* Return: Change on the total incompatibilities (0 if the
+          move is rejected).
+-------------------------------------------------------- */
+template <int ROOMS>
+int try_ejection(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int& incompatibilities, int day, int room, float T){
+  const Instance& instance = *mh.instance;
+  // Each step swaps the film in (day, room) with the one ejected next, so
+  // the films rotate along the chain
+  int delta = 0;
+  int steps = 0;
+  while (steps < EJECTION_DEPTH and (steps == 0 or delta >= 0)){
+    int next_day;
+    do next_day = mh.rng()%actual.days; while (next_day == day);
+    // Eject the film whose room suits the film moving best
+    int best_room = 0;
+    int best_delta1 = 0, best_delta2 = 0;
+    for (int i = 0; i < actual.filled[next_day]; ++i){
+      int delta1, delta2;
+      swap_delta<ROOMS>(instance, actual, day, room, next_day, i, delta1, delta2);
+      swap_films(actual, day, room, next_day, i);
+      if (i == 0 or delta1 + delta2 < best_delta1 + best_delta2){
+        best_room = i;
+        best_delta1 = delta1;
+        best_delta2 = delta2;
+      }
+    }
+    swap_films(actual, day, room, next_day, best_room);
+    day_incomp[day] += best_delta1;
+    day_incomp[next_day] += best_delta2;
+    delta += best_delta1 + best_delta2;
+    mh.ejection_days[steps] = next_day;
+    mh.ejection_rooms[steps] = best_room;
+    ++steps;
+  }
+  if (accept(mh, delta, T)){
+    incompatibilities += delta;
+    return delta;
+  }
+  // Undo the chain in reverse order
+  for (int k = steps-1; k >= 0; --k){
+    int delta1, delta2;
+    swap_delta<ROOMS>(instance, actual, day, room, mh.ejection_days[k], mh.ejection_rooms[k], delta1, delta2);
+    day_incomp[day] += delta1;
+    day_incomp[mh.ejection_days[k]] += delta2;
+  }
+  return 0;
+}
+
+/* --------------------------------------------------------
+* Name: choose_move
+* Function: Chooses a neighbourhood at random, each one with
+            a probability proportional to its recent
+            success rate.
+* Parameters: -
+* Return: The neighbourhood chosen.
+-------------------------------------------------------- */
+int choose_move(Metaheuristic& mh){
+  float total = 0;
+  for (int move = 0; move < N_MOVES; ++move) total += MIN_MOVE_WEIGHT + mh.move_success[move];
+  float random_value = mh.rng()/double(mh.rng.max())*total;
+  for (int move = 0; move < N_MOVES-1; ++move){
+    random_value -= MIN_MOVE_WEIGHT + mh.move_success[move];
+    if (random_value < 0) return move;
+  }
+  return N_MOVES-1;
+}
+
+/* --------------------------------------------------------
+* Name: initial_temperature
+* Function: Calibrates the temperature an annealing goes on
+            with after its first window: the one with which
+            the average increase of the moves of that window
+            that made the schedule worse would be accepted
+            with probability INITIAL_ACCEPTANCE. They are the
+            moves the annealing makes, so the temperature
+            fits the neighbourhoods in use.
+* Parameters: -
+* Return: Initial temperature.
+-------------------------------------------------------- */
+float initial_temperature(Metaheuristic& mh){
+  // Every move that makes it worse increases the incompatibilities by one at
+  // least
+  float average = mh.uphill_tried > 0 ? float(mh.uphill_increase)/mh.uphill_tried : 1;
+  return -average/log(INITIAL_ACCEPTANCE);
+}
+
+/* --------------------------------------------------------
+* Name: corrected_temperature
+* Function: Corrects the temperature after a window so that
+            the acceptance rate of the moves that make the
+            schedule worse gets to the target one. If all of
+            them increased the incompatibilities by the same
+            amount, the rate would be exp(-increase/T), so
+            the temperature is scaled by log(rate) /
+            log(target), between 1/MAX_CORRECTION and
+            MAX_CORRECTION.
+* Parameters: T: Temperature of the window.
+              target: Acceptance rate wanted.
+* Return: New temperature.
+-------------------------------------------------------- */
+float corrected_temperature(Metaheuristic& mh, float T, float target){
+  if (mh.uphill_tried == 0) return T;
+  // Windows where nothing was accepted still give a rate above zero
+  float rate = (mh.uphill_accepted + 0.5)/(mh.uphill_tried + 1);
+  float factor = log(rate)/log(target);
+  return T*min(MAX_CORRECTION, max(1/MAX_CORRECTION, factor));
+}
+
+/* --------------------------------------------------------
+* Name: annealing_budget
+* Function: Decides how many moves an annealing may make:
+            DEFAULT_BUDGET with no time limit and,
+            otherwise, the moves that fit in ANNEAL_SHARE of
+            the time left at the speed of the previous
+            annealings.
+* Parameters: -
+* Return: Number of moves.
+-------------------------------------------------------- */
+long annealing_budget(Metaheuristic& mh){
+  if (mh.time_limit <= 0 or mh.anneal_seconds <= 0) return DEFAULT_BUDGET;
+  double moves_per_second = mh.anneal_moves/mh.anneal_seconds;
+  return max(MIN_BUDGET, long(ANNEAL_SHARE*(mh.time_limit - mh.elapsed)*moves_per_second));
+}
+
+/* --------------------------------------------------------
+* Name: solve_incompatibilities
+* Function: Solves incompatibilities among the days and
+            returns if there persists incompatibilities
+            following an adaptive Simulated Annealing
+            algorithm. Each conflicting film is moved with a
+            neighbourhood chosen by choose_move, whose
+            success rate is updated with the result. The
+            first ANNEAL_WINDOW moves only accept the ones
+            that do not make the schedule worse and calibrate
+            the initial temperature. Then, every
+            ANNEAL_WINDOW moves, the temperature is corrected
+            so that the rate of accepted moves that make the
+            schedule worse follows a curve going from
+            INITIAL_ACCEPTANCE to FINAL_ACCEPTANCE along the
+            budget. It is raised again when the
+            incompatibilities stop going down.
+* Parameters: mh: Search.
+              actual: Matrix with the schedule (rows are
+              the days and, the columns, the cinema rooms).
+              day_incomp: Vector with how many
+              incompatibilities has each day.
+              incompatibilities: Total number of
+              incompatibilities.
+* Return: true if actual ends up with no incompatibilities,
+          false otherwise.
+-------------------------------------------------------- */
+template <int ROOMS>
+bool solve_incompatibilities(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int& incompatibilities){
+  const Instance& instance = *mh.instance;
+  // With a single day there is nowhere to move the films
+  if (actual.days < 2) return incompatibilities == 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  // Frozen until the first window calibrates the temperature
+  float T = FROZEN, initial = FROZEN;
+  long budget = annealing_budget(mh);
+  long moves = 0;
+  int fewest = incompatibilities;
+  long last_improvement = 0;
+  mh.uphill_tried = mh.uphill_accepted = mh.uphill_increase = 0;
+  // While there are incompatibilities and there are moves left
+  while (incompatibilities > 0 and moves < budget){
+    // Look for the first day with incompatibilities
+    int day_to_solve = 0;
+    while (day_to_solve < actual.days and day_incomp[day_to_solve] == 0) ++day_to_solve;
+    if (day_to_solve == actual.days) break;
+
+    // Move each film generating conflicts in that day
+    for (int film_index = 0; film_index < actual.filled[day_to_solve] and moves < budget; ++film_index){
+      if (how_many_incompatibilities<ROOMS>(instance, actual, day_to_solve, actual.schedule[day_to_solve*room_count<ROOMS>(actual) + film_index]) != 0){
+        int move = choose_move(mh);
+        int delta;
+        if (move == SWAP) delta = try_swap<ROOMS>(mh, actual, day_incomp, incompatibilities, day_to_solve, film_index, T);
+        else if (move == RELOCATE) delta = try_relocate<ROOMS>(mh, actual, day_incomp, incompatibilities, day_to_solve, film_index, T);
+        else if (move == KEMPE) delta = try_kempe<ROOMS>(mh, actual, day_incomp, incompatibilities, day_to_solve, film_index, T);
+        else delta = try_ejection<ROOMS>(mh, actual, day_incomp, incompatibilities, day_to_solve, film_index, T);
+        // Moves that reduce the incompatibilities are chosen more often
+        mh.move_success[move] = (1 - SUCCESS_MEMORY)*mh.move_success[move] + SUCCESS_MEMORY*(delta < 0);
+        moves += 1;
+        if (incompatibilities < fewest){
+          fewest = incompatibilities;
+          last_improvement = moves;
+        }
+        if (moves%ANNEAL_WINDOW == 0){
+          // Compare the acceptance rate with the one wanted at this point
+          float target = INITIAL_ACCEPTANCE*pow(FINAL_ACCEPTANCE/INITIAL_ACCEPTANCE, float(moves)/budget);
+          float rate = mh.uphill_tried > 0 ? float(mh.uphill_accepted)/mh.uphill_tried : target;
+          if (moves == ANNEAL_WINDOW) T = initial = initial_temperature(mh);
+          else T = corrected_temperature(mh, T, target);
+          // Reheat if the incompatibilities have stopped going down
+          if (moves - last_improvement >= STAGNATION*budget){
+            T = max(T, REHEAT*initial);
+            last_improvement = moves;
+          }
+          mh.uphill_tried = mh.uphill_accepted = mh.uphill_increase = 0;
+          if (mh.interrupted(mh)) budget = moves;
+          if (mh.stats != nullptr){
+            *mh.stats << mh.elapsed << "\t" << actual.days << "\t" << incompatibilities << "\t"
+                      << T << "\t" << rate << "\t" << target << endl;
+          }
+        }
+      }
+    }
+  }
+  mh.anneal_moves += moves;
+  mh.anneal_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  // If there are no incompatibilities
+  if (incompatibilities == 0){
+    report(mh, actual);
+    // We return true
+    return true;
+  }
+  // Otherwise, we return false
+  return false;
+}
+
+
+/* --------------------------------------------------------
+* Name: improve
+* Function: Tries to remove a day from the schedule
+            placing the films on the last day in empty
+            cinema rooms of previous days.
+* Parameters: mh: Search.
+              actual: Matrix with the schedule (rows are
+              the days and, the columns, the cinema rooms).
+              day_incomp: Vector with how many
+              incompatibilities has each day.
+              incompatibilities: Total number of
+              incompatibilities.
+* Return: true if the day has been removed, false if the
+          previous days have no empty cinema rooms left.
+-------------------------------------------------------- */
+template <int ROOMS>
+bool improve(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int& incompatibilities){
+  const Instance& instance = *mh.instance;
+  // Set the last day as the one to being removed
+  int day_to_remove = actual.days-1;
+  int day_to_complete;
+  int film_to_remove;
+  // Set an initial big number of incompatibilities in order to, later, find
+  // the minimum value for the variables counting them
+  int incompatibilities_generated, new_incompatibilities = 1e6;
+  // While there are films in the day to remove
+  while (actual.filled[day_to_remove] > 0){
+    // Get the film last film as the one to being removed
+    film_to_remove = actual.schedule[day_to_remove*room_count<ROOMS>(actual) + actual.filled[day_to_remove]-1];
+    // At the beginning, not empty spaces have been found
+    bool empty_spaces = false;
+    // Look for an empty space on the previous days
+    for (int i = 0; i < day_to_remove; ++i){
+      // If there are empty cinema rooms,
+      if (actual.filled[i] < room_count<ROOMS>(actual)){
+        // check the number of incompatibilities it would generate the film to
+        // remove in that spot
+        incompatibilities_generated = how_many_incompatibilities<ROOMS>(instance, actual, i, film_to_remove);
+        // If the incompatibilities generated are less than the minimum found at the moment,
+        if (incompatibilities_generated < new_incompatibilities){
+          // Update the new_incompatibilities: now the minimum is the ones just found
+          new_incompatibilities = incompatibilities_generated;
+          // And indicate on which day we can place the film in order to complete it
+          day_to_complete = i;
+          // We have found an empty space
+          empty_spaces = true;
+        }
+      }
+    }
+    // In case there are empty spaces
+    if (empty_spaces){
+      // Update incompatibilities of the day we are placing the film
+      day_incomp[day_to_complete] += new_incompatibilities;
+      // Update total incompatibilities
+      incompatibilities += new_incompatibilities;
+      // We pop the film from the day to remove
+      remove_last_film(actual, day_to_remove);
+      // And add the film to remove to the day to complete
+      place_film(actual, day_to_complete, film_to_remove);
+      // Intialize empty_spaces and new_incompatibilities again to remove the
+      // next film on the day to remove
+      empty_spaces = false;
+      new_incompatibilities = 1e6;
+    }
+    // Otherwise the day cannot be removed: every cinema room of the
+    // previous days is used
+    else return false;
+  }
+  // The day to remove is empty, so remove_last_film has already removed it
+  // from the schedule; we only clear its incompatibilities
+  day_incomp[day_to_remove] = 0;
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: GRASP
+* Function: Greedy Randomized Adaptive Search Procedure,
+            with every kernel specialized for ROOMS cinema
+            rooms (generic when ROOMS is 0).
+* Parameters: mh: Search.
+* Return: -
+-------------------------------------------------------- */
+template <int ROOMS>
+void GRASP(Metaheuristic& mh){
+  const Instance& instance = *mh.instance;
+  // The schedule and the incompatibilities of each day are allocated once
+  // and reused by every iteration
+  Organization actual;
+  init_organization(actual, instance);
+  vector<int> day_incomp(instance.n_films, 0);
+  while(not mh.interrupted(mh)){
+    // Creates a first solution
+    generate_initial_solution<ROOMS>(mh, actual);
+    int days = actual.days;
+    // If the number of days of the solution is lower than the one on the best
+    // solution, let the program know
+    report(mh, actual);
+    // Try to remove a day from the solution and, once this happens, try to
+    // solve the incompatibilities generated
+    int incompatibilities = 0;
+    fill(day_incomp.begin(), day_incomp.begin() + days, 0);
+    while (improve<ROOMS>(mh, actual, day_incomp, incompatibilities) and solve_incompatibilities<ROOMS>(mh, actual, day_incomp, incompatibilities));
+  }
+}
+
+/* --------------------------------------------------------
+* Name: polish
+* Function: Solves the incompatibilities of a schedule and,
+            while it succeeds, keeps removing its last day,
+            as every GRASP iteration does.
+* Parameters: mh: Search.
+              actual: Schedule to polish.
+              day_incomp: Vector with how many
+              incompatibilities has each day.
+              incompatibilities: Total number of
+              incompatibilities.
+              result: Last schedule without incompatibilities
+              found (output).
+* Return: true if a schedule without incompatibilities has
+          been found, false otherwise.
+-------------------------------------------------------- */
+template <int ROOMS>
+bool polish(Metaheuristic& mh, Organization& actual, vector<int>& day_incomp, int incompatibilities, Organization& result){
+  if (not solve_incompatibilities<ROOMS>(mh, actual, day_incomp, incompatibilities)) return false;
+  result = actual;
+  while (improve<ROOMS>(mh, actual, day_incomp, incompatibilities) and solve_incompatibilities<ROOMS>(mh, actual, day_incomp, incompatibilities)) result = actual;
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: distance
+* Function: Measures how different the days of two
+            schedules are: the films that would have to
+            change of day to turn the first schedule into
+            the second one, matching each day of the first
+            with the day of the second it shares more films
+            with.
+* Parameters: mh: Search.
+              a, b: Schedules to compare.
+* Return: Number of films out of place.
+-------------------------------------------------------- */
+int distance(Metaheuristic& mh, const Organization& a, const Organization& b){
+  int shared = 0;
+  for (int day = 0; day < a.days; ++day){
+    const int* day_films = &a.schedule[day*a.rooms];
+    int most = 0;
+    for (int room = 0; room < a.filled[day]; ++room) most = max(most, ++mh.overlap[b.film_day[day_films[room]]]);
+    for (int room = 0; room < a.filled[day]; ++room) mh.overlap[b.film_day[day_films[room]]] = 0;
+    shared += most;
+  }
+  return mh.instance->n_films - shared;
+}
+
+/* --------------------------------------------------------
+* Name: crossover
+* Function: Greedy partition crossover: the offspring
+            inherits whole days alternately from each
+            parent, each time the day with more films not
+            inherited yet, until it has the given number of
+            days. The films left are placed where there are
+            free cinema rooms and they generate less
+            incompatibilities.
+* Parameters: mh: Search.
+              a, b: Parents.
+              child: Offspring (output).
+              target: Days the offspring should last.
+              day_incomp: Incompatibilities of each day of
+              the offspring (output).
+* Return: Total number of incompatibilities of the offspring.
+-------------------------------------------------------- */
+template <int ROOMS>
+int crossover(Metaheuristic& mh, const Organization& a, const Organization& b, Organization& child, int target, vector<int>& day_incomp){
+  const Instance& instance = *mh.instance;
+  const Organization* parent[2] = {&a, &b};
+  clear_organization(child);
+  mh.inherited.assign(instance.n_films, false);
+  for (int p = 0; p < 2; ++p){
+    for (int day = 0; day < parent[p]->days; ++day) mh.left_on_day[p][day] = parent[p]->filled[day];
+  }
+  int p = mh.rng()%2;
+  while (child.days < target){
+    // The day of the parent with more films not inherited yet
+    int chosen = 0;
+    for (int day = 1; day < parent[p]->days; ++day) if (mh.left_on_day[p][day] > mh.left_on_day[p][chosen]) chosen = day;
+    if (mh.left_on_day[p][chosen] == 0) break;
+    int day = child.days;
+    const int* day_films = &parent[p]->schedule[chosen*parent[p]->rooms];
+    for (int room = 0; room < parent[p]->filled[chosen]; ++room){
+      int code = day_films[room];
+      if (not mh.inherited[code]){
+        place_film(child, day, code);
+        mh.inherited[code] = true;
+        // The film is no longer left on the day of the other parent
+        mh.left_on_day[1-p][parent[1-p]->film_day[code]] -= 1;
+      }
+    }
+    mh.left_on_day[p][chosen] = 0;
+    p = 1-p;
+  }
+  // Place the films left
+  for (int code = 0; code < instance.n_films; ++code){
+    if (mh.inherited[code]) continue;
+    int best_day = child.days, fewest = 1e6;
+    for (int day = 0; day < child.days; ++day){
+      if (child.filled[day] < room_count<ROOMS>(child)){
+        int generated = how_many_incompatibilities<ROOMS>(instance, child, day, code);
+        if (generated < fewest){
+          fewest = generated;
+          best_day = day;
+        }
+      }
+    }
+    place_film(child, best_day, code);
+  }
+  int incompatibilities = 0;
+  for (int day = 0; day < child.days; ++day){
+    day_incomp[day] = day_incompatibilities<ROOMS>(instance, child, day);
+    incompatibilities += day_incomp[day];
+  }
+  return incompatibilities;
+}
+
+/* --------------------------------------------------------
+* Name: add_to_pool
+* Function: Decides whether an offspring enters the pool.
+            To keep the pool diverse, an offspring too close
+            to a schedule of the pool can only replace that
+            one, and only if it is not worse. Otherwise it
+            replaces the worst schedule of the pool, if it
+            is not worse than it.
+* Parameters: mh: Search.
+              pool: Schedules of the pool.
+              offspring: Schedule that may enter the pool.
+* Return: -
+-------------------------------------------------------- */
+void add_to_pool(Metaheuristic& mh, vector<Organization>& pool, const Organization& offspring){
+  const Instance& instance = *mh.instance;
+  int closest = 0, closest_distance = instance.n_films+1, worst = 0;
+  for (int i = 0; i < int(pool.size()); ++i){
+    int d = distance(mh, offspring, pool[i]);
+    if (d < closest_distance){
+      closest_distance = d;
+      closest = i;
+    }
+    if (pool[i].days > pool[worst].days) worst = i;
+  }
+  if (closest_distance < max(1, int(MIN_DISTANCE*instance.n_films))){
+    if (closest_distance > 0 and offspring.days <= pool[closest].days) pool[closest] = offspring;
+  }
+  else if (offspring.days <= pool[worst].days) pool[worst] = offspring;
+}
+
+/* --------------------------------------------------------
+* Name: memetic_search
+* Function: Memetic algorithm: keeps a pool of schedules
+            without incompatibilities, recombines two of them
+            with a greedy partition crossover one day shorter
+            than the shortest parent and polishes the
+            offspring with the local search of GRASP.
+* Parameters: mh: Search.
+* Return: -
+-------------------------------------------------------- */
+template <int ROOMS>
+void memetic_search(Metaheuristic& mh){
+  const Instance& instance = *mh.instance;
+  Organization actual;
+  init_organization(actual, instance);
+  vector<int> day_incomp(instance.n_films, 0);
+  Organization offspring;
+  init_organization(offspring, instance);
+  // The first pool is made of polished GRASP solutions
+  vector<Organization> pool(POOL_SIZE);
+  for (int i = 0; i < POOL_SIZE; ++i){
+    generate_initial_solution<ROOMS>(mh, actual);
+    fill(day_incomp.begin(), day_incomp.begin() + actual.days, 0);
+    polish<ROOMS>(mh, actual, day_incomp, 0, pool[i]);
+  }
+  while(not mh.interrupted(mh)){
+    // Two different parents chosen at random
+    int first = mh.rng()%POOL_SIZE;
+    int second = (first + 1 + mh.rng()%(POOL_SIZE-1))%POOL_SIZE;
+    int target = max(1, min(pool[first].days, pool[second].days) - 1);
+    int incompatibilities = crossover<ROOMS>(mh, pool[first], pool[second], actual, target, day_incomp);
+    if (polish<ROOMS>(mh, actual, day_incomp, incompatibilities, offspring)) add_to_pool(mh, pool, offspring);
+  }
+}
+
+/* --------------------------------------------------------
+* Name: metaheuristic
+* Function: Runs the chosen metaheuristic, with every kernel
+            specialized for ROOMS cinema rooms (generic when
+            ROOMS is 0).
+* Parameters: mh: Search.
+* Return: -
+-------------------------------------------------------- */
+template <int ROOMS>
+void metaheuristic(Metaheuristic& mh){
+  if (mh.memetic) memetic_search<ROOMS>(mh);
+  else GRASP<ROOMS>(mh);
+}
+
+/* --------------------------------------------------------
+* Name: metaheuristic
+* Function: Runs the chosen metaheuristic with the kernels
+            specialized for the number of cinema rooms, if
+            there are some, until interrupted stops it.
+* Parameters: mh: Search.
+* Return: -
+-------------------------------------------------------- */
+inline void metaheuristic(Metaheuristic& mh){
+  switch (mh.instance->n_CinRooms){
+    case 2: metaheuristic<2>(mh); break;
+    case 3: metaheuristic<3>(mh); break;
+    case 4: metaheuristic<4>(mh); break;
+    case 5: metaheuristic<5>(mh); break;
+    case 6: metaheuristic<6>(mh); break;
+    case 7: metaheuristic<7>(mh); break;
+    case MAX_SPECIALIZED_ROOMS: metaheuristic<MAX_SPECIALIZED_ROOMS>(mh); break;
+    default: metaheuristic<0>(mh);
+  }
+}
+
+#endif
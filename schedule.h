@@ -0,0 +1,267 @@
+/*********************************************************
+File name: schedule.h
+File function: the schedule of a festival (which film is
+projected on each day and cinema room) and the search
+every solver runs on it: the state they share and the
+calls through which the program running them learns about
+the schedules found and tells them when to stop.
+**********************************************************/
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+/*********************************************************
+                        IMPORTS
+*********************************************************/
+
+#include <random>
+#include "instance.h"
+
+/***********************************************************
+                 CONSTANTS AND VARIABLES
+***********************************************************/
+
+struct Organization {
+  int days; // Number of days in use
+  int rooms; // Cinema rooms of each day
+  vector<int> schedule; // Flat days x cinema rooms matrix with the festival
+  // organization; the film of a day and room is at day*rooms + room
+  vector<int> filled; // How many cinema rooms are used on each day
+  vector<int> film_day; // Day on which each film is projected (-1 if none)
+  vector<int> film_room; // Cinema room in which each film is projected
+};
+
+struct Search {
+  const Instance* instance; // Instance being solved
+  int best_days; // Days of the best schedule known: only schedules with
+  // fewer days are reported (and, by the exhaustive search, explored)
+  mt19937 rng; // Random generator of this search
+  double time_limit; // Seconds the search may run (0 for no limit)
+  double elapsed; // Seconds it has been running, as of the last call to
+  // interrupted
+  void (*found)(Search& search, const Organization& actual); // Called with
+  // every schedule with fewer days than best_days, once best_days is lowered
+  bool (*interrupted)(Search& search); // Called from time to time: it keeps
+  // elapsed up to date, may lower best_days with schedules found elsewhere
+  // and tells whether the search has to stop
+  void* data; // What the program running the search needs in those calls
+};
+
+const int MAX_SPECIALIZED_ROOMS = 8; // Festivals with 2 to this number of
+// cinema rooms use search kernels specialized for their room count
+
+/***********************************************************
+                        FUNCTIONS
+***********************************************************/
+
+/* --------------------------------------------------------
+* Name: init_organization
+* Function: Reserves, once, all the memory a schedule can
+            need (as many days as films in the worst case)
+            so that placing and removing films never
+            allocates.
+* Parameters: actual: Schedule to initialize.
+              instance: Instance it schedules.
+* Return: -
+-------------------------------------------------------- */
+inline void init_organization(Organization& actual, const Instance& instance){
+  actual.days = 0;
+  actual.rooms = instance.n_CinRooms;
+  actual.schedule.assign(instance.n_films*instance.n_CinRooms, -1);
+  actual.filled.assign(instance.n_films, 0);
+  actual.film_day.assign(instance.n_films, -1);
+  actual.film_room.assign(instance.n_films, -1);
+}
+
+/* --------------------------------------------------------
+* Name: place_film
+* Function: Places a film in the first free cinema room of
+            a day. The days in use grow up to that day.
+* Parameters: actual: Schedule.
+              day: Day where the film is placed.
+              code: Film number.
+* Return: -
+-------------------------------------------------------- */
+inline void place_film(Organization& actual, int day, int code){
+  int room = actual.filled[day]++;
+  actual.schedule[day*actual.rooms + room] = code;
+  actual.film_day[code] = day;
+  actual.film_room[code] = room;
+  if (day >= actual.days) actual.days = day+1;
+}
+
+/* --------------------------------------------------------
+* Name: remove_last_film
+* Function: Removes the film placed in the last used
+            cinema room of a day. The days in use shrink
+            while the last one is empty.
+* Parameters: actual: Schedule.
+              day: Day from where the film is removed.
+* Return: -
+-------------------------------------------------------- */
+inline void remove_last_film(Organization& actual, int day){
+  int room = --actual.filled[day];
+  int code = actual.schedule[day*actual.rooms + room];
+  actual.film_day[code] = -1;
+  actual.film_room[code] = -1;
+  while (actual.days > 0 and actual.filled[actual.days-1] == 0) --actual.days;
+}
+
+/* --------------------------------------------------------
+* Name: clear_organization
+* Function: Empties a schedule without releasing its memory.
+* Parameters: actual: Schedule to empty.
+* Return: -
+-------------------------------------------------------- */
+inline void clear_organization(Organization& actual){
+  for (int day = 0; day < actual.days; ++day){
+    for (int room = 0; room < actual.filled[day]; ++room){
+      int code = actual.schedule[day*actual.rooms + room];
+      actual.film_day[code] = -1;
+      actual.film_room[code] = -1;
+    }
+    actual.filled[day] = 0;
+  }
+  actual.days = 0;
+}
+
+/* --------------------------------------------------------
+* Name: swap_films
+* Function: Exchanges the films placed in two slots of the
+            schedule, keeping up to date where each film is.
+* Parameters: actual: Schedule.
+              day1, room1: First slot.
+              day2, room2: Second slot.
+* Return: -
+-------------------------------------------------------- */
+inline void swap_films(Organization& actual, int day1, int room1, int day2, int room2){
+  int& code1 = actual.schedule[day1*actual.rooms + room1];
+  int& code2 = actual.schedule[day2*actual.rooms + room2];
+  swap(code1, code2);
+  actual.film_day[code1] = day1;
+  actual.film_room[code1] = room1;
+  actual.film_day[code2] = day2;
+  actual.film_room[code2] = room2;
+}
+
+/* --------------------------------------------------------
+* Name: write_schedule
+* Function: Writes a solution with the output format: time
+            required, days the festival lasts and, for each
+            film, the day and the cinema room where it is
+            projected.
+* Parameters: output_file: Where to write it.
+              instance: Instance solved.
+              best: Schedule to write.
+              time: Seconds it took to find it.
+* Return: -
+-------------------------------------------------------- */
+inline void write_schedule(const string& output_file, const Instance& instance, const Organization& best, double time){
+  // Performing the output of a file
+  ofstream file;
+  // Set decimal precision with 1 decimal
+  file.setf(ios::fixed);
+  file.precision(1);
+  // Creating or opening the file where we will write the output
+  file.open(output_file);
+  // Writes the time it has taken to compute the solution
+  file << time << endl;
+  // Writes how many days the festival lasts
+  file << best.days << endl;
+  // For each film writes on which day it will be performed and
+  // at which cinema room
+  for (int i = 0; i < best.days; ++i){
+    for (int j = 0; j < best.filled[i]; ++j){
+      file << instance.films[best.schedule[i*best.rooms + j]] << " " << i+1 << " " << instance.CinRooms[j] << endl;
+    }
+  }
+  file.close();
+}
+
+/* --------------------------------------------------------
+* Name: report
+* Function: Lets the program running the search know about
+            a schedule without incompatibilities if it has
+            fewer days than the best one.
+* Parameters: search: Search.
+              actual: Schedule found.
+* Return: -
+-------------------------------------------------------- */
+inline void report(Search& search, const Organization& actual){
+  if (actual.days < search.best_days){
+    search.best_days = actual.days;
+    search.found(search, actual);
+  }
+}
+
+/* --------------------------------------------------------
+* Name: room_count
+* Function: Gives the cinema rooms of each day: the template
+            parameter of the specialized kernels, or the
+            ones of the schedule for the generic ones
+            (ROOMS = 0).
+* Parameters: actual: Schedule.
+* Return: Cinema rooms of each day.
+-------------------------------------------------------- */
+template <int ROOMS>
+inline int room_count(const Organization& actual){
+  return ROOMS > 0 ? ROOMS : actual.rooms;
+}
+
+/* --------------------------------------------------------
+* Name: can_be_projected
+* Function: Indicates if a film can be projected on a
+            given a day depending on if it is incompatible
+            with the thers films of that day or not. When
+            ROOMS is known at compile time the loop has a
+            fixed length and is fully unrolled.
+* Parameters: instance: Instance being solved.
+              actual: Matrix with the schedule (rows are
+              the days and, the columns, the cinema rooms).
+              day: The day we want to check.
+              code: Film number.
+* Return: True if a film can be projected that day or
+          false otherwise.
+-------------------------------------------------------- */
+template <int ROOMS>
+inline bool can_be_projected(const Instance& instance, const Organization& actual, int day, int code){
+  const int* day_films = &actual.schedule[day*room_count<ROOMS>(actual)];
+  const vector<bool>& incompatible = instance.relations_graph[code];
+  int filled = actual.filled[day];
+  if (ROOMS > 0){
+    for (int room = 0; room < ROOMS; ++room) if (room < filled and incompatible[day_films[room]]) return false;
+    return true;
+  }
+  for (int room = 0; room < filled; ++room) if (incompatible[day_films[room]]) return false;
+  return true;
+}
+
+/* --------------------------------------------------------
+* Name: how_many_incompatibilities
+* Function: Counts how many incompatibilities has a given
+            film on the day it is being projected. When
+            ROOMS is known at compile time the loop has a
+            fixed length and is fully unrolled.
+* Parameters: instance: Instance being solved.
+              actual: Matrix with the schedule (rows are
+              the days and, the columns, the cinema rooms).
+              day: The day we want to check.
+              code: Film number.
+* Return: Number of incompatibilities of the film given
+          on the day it is.
+-------------------------------------------------------- */
+template <int ROOMS>
+inline int how_many_incompatibilities(const Instance& instance, const Organization& actual, int day, int code){
+  const int* day_films = &actual.schedule[day*room_count<ROOMS>(actual)];
+  const vector<bool>& incompatible = instance.relations_graph[code];
+  int filled = actual.filled[day];
+  int incompatibilities = 0;
+  if (ROOMS > 0){
+    for (int room = 0; room < ROOMS; ++room) incompatibilities += room < filled and incompatible[day_films[room]];
+    return incompatibilities;
+  }
+  for (int room = 0; room < filled; ++room) if (incompatible[day_films[room]]) incompatibilities += 1;
+  return incompatibilities;
+}
+
+#endif